@@ -3,6 +3,12 @@ let websocket;
 //const gateway = 'ws://192.168.0.108:80/ws';
 
 const gateway = `ws://${window.location.hostname}/ws`;
+// Readings format to ask for: 'format:delta', 'format:pb' or null for JSON. Firmware that does
+// not know the command keeps sending JSON.
+const preferredFormat = 'format:delta';
+// User commands go out as "<command>#<id>"; the node answers ack/nack, then done with latency
+let nextCommandId = 1;
+const pendingCommands = new Map();
 // Initialize variables
 function initAllVariables() {
   window.tests = [];
@@ -13,6 +19,7 @@ function initAllVariables() {
 function initWebSocket() {
   console.log('Trying to open a WebSocket connection...');
   websocket = new WebSocket(gateway);
+  websocket.binaryType = 'arraybuffer';
   websocket.onopen = onWebSocketOpen;
   websocket.onclose = onWebSocketClose;
   websocket.onmessage = onWebSocketMessage;
@@ -28,6 +35,10 @@ window.addEventListener('beforeunload', () => {
 // WebSocket open event
 function onWebSocketOpen(event) {
   console.log('WebSocket connection opened');
+  telemetry.synced = false;
+  if (preferredFormat) {
+    websocket.send(preferredFormat);
+  }
   getReadings();
 }
 function onWebSocketClose(event) {
@@ -47,6 +58,18 @@ function getReadings() {
   }
 }
 function onWebSocketMessage(event) {
+  if (event.data instanceof ArrayBuffer) {
+    try {
+      const frame = decodeTelemetryFrame(event.data);
+      if (applyTelemetryFrame(frame)) {
+        updateDOMElements(telemetryToReadings(telemetry));
+      }
+    } catch (error) {
+      console.error('Error decoding telemetry frame:', error);
+    }
+    return;
+  }
+
   console.log('Message from server:', event.data);
   appendLog('Message received: ' + event.data);
 
@@ -82,6 +105,25 @@ function onWebSocketMessage(event) {
           appendLog('Server: LED status update');
           updateLedStatus(data);  // Pass the entire data object to updateLedStatus
           break;
+        case 'format':
+          appendLog('Server: readings format ' + data.format);
+          break;
+        case 'ack':
+          appendLog('Server: ' + data.cmd + ' #' + data.id + ' accepted');
+          break;
+        case 'nack':
+          appendLog('Server: ' + data.cmd + ' #' + data.id + ' rejected' +
+            (data.reason ? ' (' + data.reason + ')' : ''));
+          pendingCommands.delete(data.id);
+          break;
+        case 'done': {
+          const sentAt = pendingCommands.get(data.id);
+          pendingCommands.delete(data.id);
+          const roundTrip = sentAt ? ' (' + Math.round(performance.now() - sentAt) + ' ms)' : '';
+          appendLog('Server: ' + data.cmd + ' #' + data.id + ' done, state ' + data.state +
+            roundTrip);
+          break;
+        }
         default:
           appendLog('Server: Unknown message received');
           break;
@@ -127,6 +169,137 @@ function updateLedStatus(data) {
 
 
 
+// Minimal protobuf reader for pg.TelemetryFrame and pg.PowerMeasure (proto/report.proto)
+const PowerMeasureType = { UPS_INPUT: 0, UPS_OUTPUT: 1, MAINS: 2 };
+
+function readVarint(view, pos) {
+  let value = 0;
+  let shift = 0;
+  let byte;
+  do {
+    byte = view.getUint8(pos.offset++);
+    value += (byte & 0x7f) * 2 ** shift;
+    shift += 7;
+  } while (byte & 0x80);
+  return value;
+}
+
+function skipField(view, pos, wireType) {
+  switch (wireType) {
+    case 0: readVarint(view, pos); break;
+    case 1: pos.offset += 8; break;
+    case 2: pos.offset += readVarint(view, pos); break;
+    case 5: pos.offset += 4; break;
+    default: throw new Error('Unsupported wire type ' + wireType);
+  }
+}
+
+function decodePowerMeasure(view, pos, end) {
+  // proto3 omits zero fields, so start from the defaults
+  const channel = {
+    type: 0, voltage: 0, current: 0, power: 0, pf: 0, meterId: 0, frequency: 0, changed: 0
+  };
+  const floats = { 2: 'voltage', 3: 'current', 4: 'power', 5: 'pf', 7: 'frequency' };
+  while (pos.offset < end) {
+    const key = readVarint(view, pos);
+    const field = Math.floor(key / 8);
+    const wireType = key & 7;
+    if (floats[field] && wireType === 5) {
+      channel[floats[field]] = view.getFloat32(pos.offset, true);
+      pos.offset += 4;
+    } else if (field === 1 && wireType === 0) {
+      channel.type = readVarint(view, pos);
+    } else if (field === 6 && wireType === 0) {
+      channel.meterId = readVarint(view, pos);
+    } else if (field === 8 && wireType === 0) {
+      channel.changed = readVarint(view, pos);
+    } else {
+      skipField(view, pos, wireType);
+    }
+  }
+  return channel;
+}
+
+function decodeTelemetryFrame(buffer) {
+  const view = new DataView(buffer);
+  const pos = { offset: 0 };
+  const frame = { sequence: 0, timestampMs: 0, state: 0, channels: [], keyFrame: false };
+  while (pos.offset < view.byteLength) {
+    const key = readVarint(view, pos);
+    const field = Math.floor(key / 8);
+    const wireType = key & 7;
+    if (field === 1 && wireType === 0) {
+      frame.sequence = readVarint(view, pos);
+    } else if (field === 2 && wireType === 0) {
+      frame.timestampMs = readVarint(view, pos);
+    } else if (field === 3 && wireType === 0) {
+      frame.state = readVarint(view, pos);
+    } else if (field === 4 && wireType === 2) {
+      const length = readVarint(view, pos);
+      frame.channels.push(decodePowerMeasure(view, pos, pos.offset + length));
+    } else if (field === 5 && wireType === 0) {
+      frame.keyFrame = readVarint(view, pos) !== 0;
+    } else {
+      skipField(view, pos, wireType);
+    }
+  }
+  return frame;
+}
+
+// Latest value of every channel; delta frames are applied on top of the last key frame
+const telemetry = { synced: false, sequence: 0, channels: [] };
+const deltaFields = { 2: 'voltage', 3: 'current', 4: 'power', 5: 'pf', 7: 'frequency' };
+
+// Returns true when the readings changed. Full frames ('format:pb') carry no key flag but are
+// complete, so they are taken as they come.
+function applyTelemetryFrame(frame) {
+  const isDelta = preferredFormat === 'format:delta';
+  if (!isDelta || frame.keyFrame) {
+    telemetry.channels = frame.channels;
+    telemetry.synced = true;
+  } else if (!telemetry.synced || frame.sequence !== telemetry.sequence + 1) {
+    // Lost a frame: wait for the key frame the resync asks for
+    if (telemetry.synced) {
+      appendLog('Telemetry gap after #' + telemetry.sequence + ', requesting resync');
+      sendWebSocketCommand('resync');
+    }
+    telemetry.synced = false;
+    telemetry.sequence = frame.sequence;
+    return false;
+  } else {
+    for (const delta of frame.channels) {
+      const channel = telemetry.channels.find((c) => c.meterId === delta.meterId);
+      if (!channel) {
+        continue;
+      }
+      for (const [tag, name] of Object.entries(deltaFields)) {
+        if (delta.changed & (1 << tag)) {
+          channel[name] = delta[name];
+        }
+      }
+    }
+  }
+  telemetry.sequence = frame.sequence;
+  return true;
+}
+
+// Same shape as the JSON readings, from the first input and output channel
+function telemetryToReadings(frame) {
+  const round = (value) => Math.round(value * 100) / 100;
+  const readings = {};
+  const sides = [['input', PowerMeasureType.UPS_INPUT], ['output', PowerMeasureType.UPS_OUTPUT]];
+  for (const [side, type] of sides) {
+    const channel = frame.channels.find((c) => c.type === type);
+    if (channel) {
+      readings[side + 'Voltage'] = round(channel.voltage);
+      readings[side + 'Current'] = round(channel.current);
+      readings[side + 'Wattage'] = round(channel.power);
+      readings[side + 'PowerFactor'] = channel.pf;
+    }
+  }
+  return readings;
+}
+
 // Update DOM elements based on WebSocket message data
 function updateDOMElements(data) {
   if (data.inputPowerFactor !== undefined) {
@@ -273,19 +446,19 @@ function sendTest() {
 // Start test via WebSocket
 function startTest() {
   appendLog('Test started at ' + new Date().toLocaleString());
-  sendWebSocketCommand('start');
+  sendUserCommand('start');
 }
 
 // Stop test via WebSocket
 function stopTest() {
   appendLog('Test stopped at ' + new Date().toLocaleString());
-  sendWebSocketCommand('stop');
+  sendUserCommand('stop');
 }
 
 // Pause test via WebSocket
 function pauseTest() {
   appendLog('Test paused at ' + new Date().toLocaleString());
-  sendWebSocketCommand('pause');
+  sendUserCommand('pause');
 }
 
 // Send mode via WebSocket
@@ -293,7 +466,14 @@ function sendMode() {
   const modeSelect = document.querySelector('input[name="mode"]:checked');
   const mode = modeSelect ? modeSelect.value : null;
   appendLog('Sending Mode: ' + mode + ' at ' + new Date().toLocaleString());
-  sendWebSocketCommand(mode);
+  sendUserCommand(mode);
+}
+
+// Send a user command tagged with a request id
+function sendUserCommand(command) {
+  const id = nextCommandId++;
+  pendingCommands.set(id, performance.now());
+  sendWebSocketCommand(command + '#' + id);
 }
 
 // Send command via WebSocket
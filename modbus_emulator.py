@@ -0,0 +1,440 @@
+"""Host-side Modbus TCP stand-in for the PZEM meters and the coil server.
+
+serve: emulate N meters on one Modbus TCP port. Each meter answers FC 03/04 with the
+       15 register OutBox image parseOutBox() expects, and coils 0-4 on FC 01/05/0F.
+load:  drive an emulator (or real gateway) the way ModbusManager does and report
+       requests/sec, latency percentiles, timeouts and reconnects.
+status: read the node's own ModbusStatusServer register map the way a line PLC would and
+       print it decoded, once or every --watch-s seconds.
+
+Examples:
+    python modbus_emulator.py serve --port 1502 --meters 4 --latency-ms 20 --jitter-ms 10
+    python modbus_emulator.py serve --drop-rate 0.02 --exception-rate 0.01 --disconnect-rate 0.005
+    python modbus_emulator.py load --port 1502 --meters 4 --connections 2 --duration 30
+    python modbus_emulator.py status --host 192.168.0.50 --port 502 --watch-s 1
+"""
+
+import argparse
+import asyncio
+import math
+import random
+import struct
+import sys
+import time
+
+# Matches Node_Core::MeasureType
+MEASURE_INPUT = 0
+MEASURE_OUTPUT = 1
+
+# Matches ModbusManager coil addresses UPS_IN .. TEST_UPDATE
+COIL_COUNT = 5
+
+OUTBOX_REGISTERS = 15
+
+EX_ILLEGAL_FUNCTION = 0x01
+EX_ILLEGAL_ADDRESS = 0x02
+EX_ILLEGAL_VALUE = 0x03
+EX_DEVICE_FAILURE = 0x04
+
+# The two meters main.cpp polls, followed by generic output meters at address 0
+DEFAULT_LAYOUT = [(1, 761, MEASURE_INPUT), (2, 123, MEASURE_OUTPUT)]
+
+
+class Meter:
+    """One PZEM device: an OutBox register block plus the coil bank."""
+
+    def __init__(self, slave_id, address, role, model, args):
+        self.slave_id = slave_id
+        self.address = address
+        self.role = role
+        self.dc = model == 'pzem003'
+        self.args = args
+        self.energy = 0.0
+        self.last_update = time.monotonic()
+        self.phase = random.uniform(0, 2 * math.pi)
+        self.coils = [False] * COIL_COUNT
+
+    def sample(self):
+        now = time.monotonic()
+        elapsed = now - self.last_update
+        self.last_update = now
+
+        wave = math.sin(2 * math.pi * now / self.args.period_s + self.phase)
+        noise = random.gauss(0, self.args.noise)
+
+        if self.dc:
+            voltage = self.args.dc_voltage * (1 + 0.02 * wave + noise)
+            frequency = 0.0
+            pf = 1.0
+        else:
+            voltage = self.args.voltage * (1 + 0.03 * wave + noise)
+            frequency = 50.0 + 0.05 * wave
+            pf = min(1.0, max(0.0, self.args.pf + 0.02 * wave))
+
+        # Load steps follow the load bank coils so switch tests see the power move
+        steps = 1 + sum(1 for coil in self.coils[1:4] if coil)
+        current = self.args.current * steps / 4 * (1 + 0.05 * wave + noise)
+        if self.role == MEASURE_OUTPUT:
+            current *= self.args.efficiency
+
+        power = voltage * current * pf
+        self.energy += power * elapsed / 3600.0
+
+        return voltage, current, power, self.energy, pf, frequency
+
+    def registers(self):
+        voltage, current, power, energy, pf, frequency = self.sample()
+        regs = [self.slave_id, self.role]
+        for value in (voltage, current, power, energy, pf, frequency):
+            # parseOutBox reads floats high word first
+            high, low = struct.unpack('>HH', struct.pack('>f', value))
+            regs += [high, low]
+        regs.append(1)  # isValid
+        return regs
+
+
+class Stats:
+    def __init__(self):
+        self.requests = 0
+        self.replies = 0
+        self.dropped = 0
+        self.exceptions = 0
+        self.disconnects = 0
+        self.connections = 0
+
+    def line(self):
+        return (f"req={self.requests} rep={self.replies} drop={self.dropped} "
+                f"exc={self.exceptions} disc={self.disconnects} conn={self.connections}")
+
+
+def exception_pdu(function_code, code):
+    return bytes([function_code | 0x80, code])
+
+
+def handle_pdu(meter, pdu):
+    function_code = pdu[0]
+
+    if function_code in (0x03, 0x04):
+        if len(pdu) < 5:
+            return exception_pdu(function_code, EX_ILLEGAL_VALUE)
+        address, count = struct.unpack('>HH', pdu[1:5])
+        if count < 1 or count > 125:
+            return exception_pdu(function_code, EX_ILLEGAL_VALUE)
+        offset = address - meter.address
+        if offset < 0 or offset >= OUTBOX_REGISTERS:
+            return exception_pdu(function_code, EX_ILLEGAL_ADDRESS)
+        # Reads past the OutBox block are zero padded, as main.cpp asks for 21 registers
+        regs = meter.registers()[offset:] + [0] * count
+        return bytes([function_code, count * 2]) + struct.pack(f'>{count}H', *regs[:count])
+
+    if function_code == 0x01:
+        if len(pdu) < 5:
+            return exception_pdu(function_code, EX_ILLEGAL_VALUE)
+        address, count = struct.unpack('>HH', pdu[1:5])
+        if count < 1 or address + count > COIL_COUNT:
+            return exception_pdu(function_code, EX_ILLEGAL_ADDRESS)
+        packed = bytearray((count + 7) // 8)
+        for i in range(count):
+            if meter.coils[address + i]:
+                packed[i // 8] |= 1 << (i % 8)
+        return bytes([function_code, len(packed)]) + bytes(packed)
+
+    if function_code == 0x05:
+        if len(pdu) < 5:
+            return exception_pdu(function_code, EX_ILLEGAL_VALUE)
+        address, value = struct.unpack('>HH', pdu[1:5])
+        if address >= COIL_COUNT:
+            return exception_pdu(function_code, EX_ILLEGAL_ADDRESS)
+        if value not in (0x0000, 0xFF00):
+            return exception_pdu(function_code, EX_ILLEGAL_VALUE)
+        meter.coils[address] = value == 0xFF00
+        return pdu[:5]
+
+    if function_code == 0x0F:
+        if len(pdu) < 6:
+            return exception_pdu(function_code, EX_ILLEGAL_VALUE)
+        address, count, byte_count = struct.unpack('>HHB', pdu[1:6])
+        if count < 1 or address + count > COIL_COUNT:
+            return exception_pdu(function_code, EX_ILLEGAL_ADDRESS)
+        if byte_count != (count + 7) // 8 or len(pdu) < 6 + byte_count:
+            return exception_pdu(function_code, EX_ILLEGAL_VALUE)
+        for i in range(count):
+            meter.coils[address + i] = bool(pdu[6 + i // 8] & (1 << (i % 8)))
+        return pdu[:5]
+
+    return exception_pdu(function_code, EX_ILLEGAL_FUNCTION)
+
+
+async def serve_client(reader, writer, meters, args, stats):
+    stats.connections += 1
+    peer = writer.get_extra_info('peername')
+    print(f"Client connected: {peer}")
+    try:
+        while True:
+            header = await reader.readexactly(7)
+            transaction, protocol, length, unit = struct.unpack('>HHHB', header)
+            if length < 2 or length > 254:
+                break
+            pdu = await reader.readexactly(length - 1)
+            stats.requests += 1
+
+            if random.random() < args.disconnect_rate:
+                stats.disconnects += 1
+                break
+            if random.random() < args.drop_rate:
+                stats.dropped += 1
+                continue
+
+            delay = max(0.0, random.gauss(args.latency_ms, args.jitter_ms)) / 1000.0
+            if delay:
+                await asyncio.sleep(delay)
+
+            meter = meters.get(unit)
+            if meter is None:
+                # Gateways answer 0x0B (target failed to respond) for unknown units
+                reply = exception_pdu(pdu[0], 0x0B)
+                stats.exceptions += 1
+            elif random.random() < args.exception_rate:
+                reply = exception_pdu(pdu[0], EX_DEVICE_FAILURE)
+                stats.exceptions += 1
+            else:
+                reply = handle_pdu(meter, pdu)
+                if reply[0] & 0x80:
+                    stats.exceptions += 1
+
+            writer.write(struct.pack('>HHHB', transaction, protocol, len(reply) + 1, unit) + reply)
+            await writer.drain()
+            stats.replies += 1
+    except (asyncio.IncompleteReadError, ConnectionError):
+        pass
+    finally:
+        writer.close()
+        print(f"Client disconnected: {peer}")
+
+
+def build_meters(args):
+    layout = list(DEFAULT_LAYOUT)
+    for slave_id in range(len(layout) + 1, args.meters + 1):
+        layout.append((slave_id, 0, MEASURE_OUTPUT))
+    return {slave_id: Meter(slave_id, address, role, args.model, args)
+            for slave_id, address, role in layout[:args.meters]}
+
+
+async def run_server(args):
+    meters = build_meters(args)
+    stats = Stats()
+    server = await asyncio.start_server(
+        lambda r, w: serve_client(r, w, meters, args, stats), args.host, args.port)
+
+    for meter in meters.values():
+        role = 'input' if meter.role == MEASURE_INPUT else 'output'
+        print(f"Meter {meter.slave_id}: {args.model} {role} at register {meter.address}")
+    print(f"Listening on {args.host}:{args.port}")
+
+    async with server:
+        while True:
+            await asyncio.sleep(args.report_s)
+            print(stats.line())
+
+
+def percentile(sorted_values, fraction):
+    if not sorted_values:
+        return 0.0
+    index = min(len(sorted_values) - 1, int(fraction * len(sorted_values)))
+    return sorted_values[index]
+
+
+async def load_worker(args, slave_ids, latencies, counters, deadline):
+    reader = writer = None
+    addresses = {slave_id: address for slave_id, address, _ in DEFAULT_LAYOUT}
+    transaction = 0
+    turn = 0
+
+    while time.monotonic() < deadline:
+        if writer is None:
+            try:
+                reader, writer = await asyncio.wait_for(
+                    asyncio.open_connection(args.host, args.port), args.timeout_ms / 1000.0)
+                counters['connects'] += 1
+            except (OSError, asyncio.TimeoutError):
+                counters['connect_failures'] += 1
+                await asyncio.sleep(args.backoff_ms / 1000.0)
+                continue
+
+        slave_id = slave_ids[turn % len(slave_ids)]
+        address = addresses.get(slave_id, 0)
+        turn += 1
+        transaction = (transaction + 1) & 0xFFFF
+        request = struct.pack('>HHHBBHH', transaction, 0, 6, slave_id, 0x03, address,
+                              args.registers)
+
+        start = time.perf_counter()
+        try:
+            writer.write(request)
+            await writer.drain()
+            header = await asyncio.wait_for(reader.readexactly(7), args.timeout_ms / 1000.0)
+            _, _, length, _ = struct.unpack('>HHHB', header)
+            pdu = await asyncio.wait_for(reader.readexactly(length - 1), args.timeout_ms / 1000.0)
+        except asyncio.TimeoutError:
+            # A late reply would desynchronise the stream, so start over like eModbus does
+            counters['timeouts'] += 1
+            writer.close()
+            writer = None
+            continue
+        except (asyncio.IncompleteReadError, ConnectionError):
+            counters['disconnects'] += 1
+            writer = None
+            continue
+
+        latencies.append((time.perf_counter() - start) * 1000.0)
+        if pdu[0] & 0x80:
+            counters['exceptions'] += 1
+        else:
+            counters['ok'] += 1
+
+        if args.interval_ms:
+            await asyncio.sleep(args.interval_ms / 1000.0)
+
+    if writer is not None:
+        writer.close()
+
+
+async def run_load(args):
+    slave_ids = list(range(1, args.meters + 1))
+    latencies = []
+    counters = dict(ok=0, exceptions=0, timeouts=0, disconnects=0, connects=0,
+                    connect_failures=0)
+
+    start = time.monotonic()
+    deadline = start + args.duration
+    await asyncio.gather(*(load_worker(args, slave_ids, latencies, counters, deadline)
+                           for _ in range(args.connections)))
+    elapsed = time.monotonic() - start
+
+    latencies.sort()
+    total = counters['ok'] + counters['exceptions']
+    print(f"Meters {args.meters}, connections {args.connections}, {elapsed:.1f} s")
+    print(f"Throughput {total / elapsed:.1f} req/s ({counters['ok']} ok, "
+          f"{counters['exceptions']} exceptions, {counters['timeouts']} timeouts)")
+    print(f"Latency ms p50 {percentile(latencies, 0.50):.2f}  p90 {percentile(latencies, 0.90):.2f}"
+          f"  p99 {percentile(latencies, 0.99):.2f}  max {percentile(latencies, 1.0):.2f}")
+    print(f"Connections {counters['connects']} opened, {counters['disconnects']} dropped, "
+          f"{counters['connect_failures']} failed")
+
+
+# Matches ModbusStatusServer's register map
+STATUS_WORDS = 75
+STATUS_STATES = ['DEVICE_ON', 'DEVICE_OK', 'DEVICE_SETUP', 'DEVICE_READY', 'READY_TO_PROCEED',
+                 'TEST_START', 'TEST_RUNNING', 'CURRENT_TEST_CHECK', 'CURRENT_TEST_OK',
+                 'READY_NEXT_TEST', 'MANUAL_NEXT_TEST', 'RETEST', 'SYSTEM_PAUSED',
+                 'ALL_TEST_DONE', 'START_FROM_SAVE', 'RECOVER_DATA', 'ADDENDUM_TEST_DATA',
+                 'FAILED_TEST', 'TRANSPORT_DATA', 'SYSTEM_TUNING', 'FAULT',
+                 'USER_CHECK_REQUIRED', 'WAITING_FOR_USER']
+STATUS_TESTS = {1: 'SwitchTest', 2: 'BackupTest', 4: 'EfficiencyTest', 8: 'InputVoltageTest',
+                16: 'WaveformTest', 32: 'TunePWMTest'}
+
+
+def words_to_float(words, index):
+    return struct.unpack('>f', struct.pack('>HH', words[index], words[index + 1]))[0]
+
+
+def decode_status(words):
+    state = words[2]
+    lines = [f"map v{words[0]}  heartbeat {words[1]}  state "
+             f"{STATUS_STATES[state] if state < len(STATUS_STATES) else state}  test "
+             f"{STATUS_TESTS.get(words[3], '-')} {'running' if words[4] else 'idle'}"]
+    for name, base in (('switch', 10), ('backup', 30)):
+        results = []
+        for slot in range(5):
+            valid, load, high, low = words[base + slot * 4:base + slot * 4 + 4]
+            results.append(f"{load}%:{(high << 16) | low}ms" if valid else '-')
+        lines.append(f"{name:<7}" + '  '.join(results))
+    for name, base in (('input', 50), ('output', 60)):
+        volts, amps, watts, pf, hz = (words_to_float(words, base + i * 2) for i in range(5))
+        lines.append(f"{name:<7}{volts:.1f} V  {amps:.3f} A  {watts:.1f} W  pf {pf:.2f}  "
+                     f"{hz:.1f} Hz")
+    lines.append(f"eff    {words_to_float(words, 70):.4f} +/- {words_to_float(words, 72):.4f} "
+                 f"({words[74]} pairs)")
+    return '\n'.join(lines)
+
+
+async def run_status(args):
+    reader, writer = await asyncio.wait_for(asyncio.open_connection(args.host, args.port),
+                                            args.timeout_ms / 1000.0)
+    transaction = 0
+    try:
+        while True:
+            transaction = (transaction + 1) & 0xFFFF
+            writer.write(struct.pack('>HHHBBHH', transaction, 0, 6, args.unit, 0x04, 0,
+                                     STATUS_WORDS))
+            await writer.drain()
+            header = await asyncio.wait_for(reader.readexactly(7), args.timeout_ms / 1000.0)
+            _, _, length, _ = struct.unpack('>HHHB', header)
+            pdu = await asyncio.wait_for(reader.readexactly(length - 1), args.timeout_ms / 1000.0)
+            if pdu[0] & 0x80:
+                print(f"Exception {pdu[1]:#04x}")
+            else:
+                print(decode_status(struct.unpack(f'>{pdu[1] // 2}H', pdu[2:])))
+            if not args.watch_s:
+                break
+            print()
+            await asyncio.sleep(args.watch_s)
+    finally:
+        writer.close()
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__,
+                                     formatter_class=argparse.RawDescriptionHelpFormatter)
+    sub = parser.add_subparsers(dest='mode', required=True)
+
+    serve = sub.add_parser('serve', help='emulate PZEM meters and the coil server')
+    serve.add_argument('--host', default='0.0.0.0')
+    serve.add_argument('--port', type=int, default=1502)
+    serve.add_argument('--meters', type=int, default=2)
+    serve.add_argument('--model', choices=['pzem004t', 'pzem003'], default='pzem004t')
+    serve.add_argument('--latency-ms', type=float, default=0.0)
+    serve.add_argument('--jitter-ms', type=float, default=0.0)
+    serve.add_argument('--drop-rate', type=float, default=0.0, help='requests left unanswered')
+    serve.add_argument('--exception-rate', type=float, default=0.0,
+                       help='requests answered with exception 04')
+    serve.add_argument('--disconnect-rate', type=float, default=0.0,
+                       help='requests that close the connection')
+    serve.add_argument('--voltage', type=float, default=230.0)
+    serve.add_argument('--dc-voltage', type=float, default=48.0)
+    serve.add_argument('--current', type=float, default=4.0, help='current at full load')
+    serve.add_argument('--pf', type=float, default=0.95)
+    serve.add_argument('--efficiency', type=float, default=0.92,
+                       help='output/input current ratio')
+    serve.add_argument('--period-s', type=float, default=20.0, help='waveform period')
+    serve.add_argument('--noise', type=float, default=0.002, help='relative gaussian noise')
+    serve.add_argument('--report-s', type=float, default=10.0)
+
+    load = sub.add_parser('load', help='measure throughput and latency against a server')
+    load.add_argument('--host', default='127.0.0.1')
+    load.add_argument('--port', type=int, default=1502)
+    load.add_argument('--meters', type=int, default=2)
+    load.add_argument('--connections', type=int, default=1)
+    load.add_argument('--registers', type=int, default=21, help='registers per read, as main.cpp')
+    load.add_argument('--duration', type=float, default=10.0)
+    load.add_argument('--interval-ms', type=float, default=0.0, help='pause between requests')
+    load.add_argument('--timeout-ms', type=float, default=4000.0)
+    load.add_argument('--backoff-ms', type=float, default=500.0)
+
+    status = sub.add_parser('status', help="read the node's PLC register map")
+    status.add_argument('--host', default='127.0.0.1')
+    status.add_argument('--port', type=int, default=502)
+    status.add_argument('--unit', type=int, default=1)
+    status.add_argument('--watch-s', type=float, default=0.0)
+    status.add_argument('--timeout-ms', type=float, default=4000.0)
+
+    args = parser.parse_args()
+    modes = {'serve': run_server, 'load': run_load, 'status': run_status}
+    try:
+        asyncio.run(modes[args.mode](args))
+    except KeyboardInterrupt:
+        sys.exit(0)
+
+
+if __name__ == '__main__':
+    main()
@@ -9,6 +9,9 @@
 PB_BIND(pg_PowerMeasure, pg_PowerMeasure, AUTO)
 
 
+PB_BIND(pg_TelemetryFrame, pg_TelemetryFrame, AUTO)
+
+
 
 
 
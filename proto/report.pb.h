@@ -16,6 +16,20 @@ typedef enum _pg_PowerMeasureType {
     pg_PowerMeasureType_MAINS = 2
 } pg_PowerMeasureType;
 
+typedef enum _pg_TestResult {
+    pg_TestResult_TEST_FAILED = 0,
+    pg_TestResult_TEST_PENDING = 1,
+    pg_TestResult_TEST_SUCCESSFUL = 2
+} pg_TestResult;
+
+typedef enum _pg_TestType {
+    pg_TestType_SwitchTest = 0,
+    pg_TestType_BackupTest = 1,
+    pg_TestType_EfficiencyTest = 2,
+    pg_TestType_InputVoltageTest = 3,
+    pg_TestType_WaveformTest = 4
+} pg_TestType;
+
 /* Struct definitions */
 typedef struct _pg_PowerMeasure {
     pg_PowerMeasureType type;
@@ -23,8 +37,24 @@ typedef struct _pg_PowerMeasure {
     float current;
     float power;
     float pf;
+    uint32_t meter_id;
+    float frequency;
+    /* Delta frames only: bit (1 << tag) for every value field carried, the rest are unchanged */
+    uint32_t changed;
 } pg_PowerMeasure;
 
+/* Live feed for binary WebSocket clients, one channel per registered meter */
+typedef struct _pg_TelemetryFrame {
+    uint32_t sequence;
+    uint32_t timestamp_ms;
+    uint32_t state;
+    pb_size_t channels_count;
+    pg_PowerMeasure channels[8];
+    /* Delta stream: key frames carry every channel in full, the frames between carry only
+ channels and fields that moved past their deadband since the last value sent */
+    bool key_frame;
+} pg_TelemetryFrame;
+
 
 #ifdef __cplusplus
 extern "C" {
@@ -35,12 +65,23 @@ extern "C" {
 #define _pg_PowerMeasureType_MAX pg_PowerMeasureType_MAINS
 #define _pg_PowerMeasureType_ARRAYSIZE ((pg_PowerMeasureType)(pg_PowerMeasureType_MAINS+1))
 
+#define _pg_TestResult_MIN pg_TestResult_TEST_FAILED
+#define _pg_TestResult_MAX pg_TestResult_TEST_SUCCESSFUL
+#define _pg_TestResult_ARRAYSIZE ((pg_TestResult)(pg_TestResult_TEST_SUCCESSFUL+1))
+
+#define _pg_TestType_MIN pg_TestType_SwitchTest
+#define _pg_TestType_MAX pg_TestType_WaveformTest
+#define _pg_TestType_ARRAYSIZE ((pg_TestType)(pg_TestType_WaveformTest+1))
+
 #define pg_PowerMeasure_type_ENUMTYPE pg_PowerMeasureType
 
 
+
 /* Initializer values for message structs */
-#define pg_PowerMeasure_init_default             {_pg_PowerMeasureType_MIN, 0, 0, 0, 0}
-#define pg_PowerMeasure_init_zero                {_pg_PowerMeasureType_MIN, 0, 0, 0, 0}
+#define pg_PowerMeasure_init_default             {_pg_PowerMeasureType_MIN, 0, 0, 0, 0, 0, 0, 0}
+#define pg_TelemetryFrame_init_default           {0, 0, 0, 0, {pg_PowerMeasure_init_default, pg_PowerMeasure_init_default, pg_PowerMeasure_init_default, pg_PowerMeasure_init_default, pg_PowerMeasure_init_default, pg_PowerMeasure_init_default, pg_PowerMeasure_init_default, pg_PowerMeasure_init_default}, 0}
+#define pg_PowerMeasure_init_zero                {_pg_PowerMeasureType_MIN, 0, 0, 0, 0, 0, 0, 0}
+#define pg_TelemetryFrame_init_zero              {0, 0, 0, 0, {pg_PowerMeasure_init_zero, pg_PowerMeasure_init_zero, pg_PowerMeasure_init_zero, pg_PowerMeasure_init_zero, pg_PowerMeasure_init_zero, pg_PowerMeasure_init_zero, pg_PowerMeasure_init_zero, pg_PowerMeasure_init_zero}, 0}
 
 /* Field tags (for use in manual encoding/decoding) */
 #define pg_PowerMeasure_type_tag                 1
@@ -48,6 +89,14 @@ extern "C" {
 #define pg_PowerMeasure_current_tag              3
 #define pg_PowerMeasure_power_tag                4
 #define pg_PowerMeasure_pf_tag                   5
+#define pg_PowerMeasure_meter_id_tag             6
+#define pg_PowerMeasure_frequency_tag            7
+#define pg_PowerMeasure_changed_tag              8
+#define pg_TelemetryFrame_sequence_tag           1
+#define pg_TelemetryFrame_timestamp_ms_tag       2
+#define pg_TelemetryFrame_state_tag              3
+#define pg_TelemetryFrame_channels_tag           4
+#define pg_TelemetryFrame_key_frame_tag          5
 
 /* Struct field encoding specification for nanopb */
 #define pg_PowerMeasure_FIELDLIST(X, a) \
@@ -55,18 +104,34 @@ X(a, STATIC,   SINGULAR, UENUM,    type,              1) \
 X(a, STATIC,   SINGULAR, FLOAT,    voltage,           2) \
 X(a, STATIC,   SINGULAR, FLOAT,    current,           3) \
 X(a, STATIC,   SINGULAR, FLOAT,    power,             4) \
-X(a, STATIC,   SINGULAR, FLOAT,    pf,                5)
+X(a, STATIC,   SINGULAR, FLOAT,    pf,                5) \
+X(a, STATIC,   SINGULAR, UINT32,   meter_id,          6) \
+X(a, STATIC,   SINGULAR, FLOAT,    frequency,         7) \
+X(a, STATIC,   SINGULAR, UINT32,   changed,           8)
 #define pg_PowerMeasure_CALLBACK NULL
 #define pg_PowerMeasure_DEFAULT NULL
 
+#define pg_TelemetryFrame_FIELDLIST(X, a) \
+X(a, STATIC,   SINGULAR, UINT32,   sequence,          1) \
+X(a, STATIC,   SINGULAR, UINT32,   timestamp_ms,      2) \
+X(a, STATIC,   SINGULAR, UINT32,   state,             3) \
+X(a, STATIC,   REPEATED, MESSAGE,  channels,          4) \
+X(a, STATIC,   SINGULAR, BOOL,     key_frame,         5)
+#define pg_TelemetryFrame_CALLBACK NULL
+#define pg_TelemetryFrame_DEFAULT NULL
+#define pg_TelemetryFrame_channels_MSGTYPE pg_PowerMeasure
+
 extern const pb_msgdesc_t pg_PowerMeasure_msg;
+extern const pb_msgdesc_t pg_TelemetryFrame_msg;
 
 /* Defines for backwards compatibility with code written before nanopb-0.4.0 */
 #define pg_PowerMeasure_fields &pg_PowerMeasure_msg
+#define pg_TelemetryFrame_fields &pg_TelemetryFrame_msg
 
 /* Maximum encoded size of messages (where known) */
-#define PG_REPORT_PB_H_MAX_SIZE                  pg_PowerMeasure_size
-#define pg_PowerMeasure_size                     22
+#define PG_REPORT_PB_H_MAX_SIZE                  pg_TelemetryFrame_size
+#define pg_PowerMeasure_size                     39
+#define pg_TelemetryFrame_size                   348
 
 #ifdef __cplusplus
 } /* extern "C" */
@@ -1,8 +1,10 @@
 #include "BackupTest.h"
+#include "PZEM_Modbus.hpp"
 
 // extern EventGroupHandle_t eventGroupTest;
 
 extern QueueHandle_t TestManageQueue;
+extern Node_Utility::ModbusManager& MBManager;
 
 using namespace Node_Core;
 
@@ -19,6 +21,7 @@ void BackupTest::init()
 			test.starttime = 0;
 			test.endtime = 0;
 			test.load_percentage = LoadPercentage::LOAD_0P;
+			test.calibration_version = 0;
 		};
 		_initialized_BT = true;
 
@@ -157,6 +160,9 @@ bool BackupTest::processTestImpl()
 			_data_BT.backupTest[_currentTest_BT].valid_data = true;
 			_data_BT.backupTest[_currentTest_BT].testNo = _currentTest_BT + 1;
 			_data_BT.backupTest[_currentTest_BT].testTimestamp = millis();
+			// The version the readings were corrected with, not the one configured since
+			_data_BT.backupTest[_currentTest_BT].calibration_version =
+				MBManager.calibrationVersion();
 			_data_BT.backupTest[_currentTest_BT].backuptime = backuptime;
 			logger.log(LogLevel::SUCCESS, "Processing successful");
 			return true;
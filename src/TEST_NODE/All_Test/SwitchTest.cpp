@@ -1,9 +1,11 @@
 #include "SwitchTest.h"
+#include "PZEM_Modbus.hpp"
 
 
 using namespace Node_Core;
 
 extern QueueHandle_t TestManageQueue;
+extern Node_Utility::ModbusManager& MBManager;
 void SwitchTest::init()
 {
 	if(!_initialized_SW)
@@ -17,6 +19,7 @@ void SwitchTest::init()
 			test.starttime = 0;
 			test.endtime = 0;
 			test.load_percentage = LoadPercentage::LOAD_0P;
+			test.calibration_version = 0;
 		};
 		_initialized_SW = true;
 
@@ -157,6 +160,9 @@ bool SwitchTest::processTestImpl()
 			_data_SW.switchTest[_currentTest_SW].valid_data = true;
 			_data_SW.switchTest[_currentTest_SW].testNo = _currentTest_SW + 1;
 			_data_SW.switchTest[_currentTest_SW].testTimestamp = millis();
+			// The version the readings were corrected with, not the one configured since
+			_data_SW.switchTest[_currentTest_SW].calibration_version =
+				MBManager.calibrationVersion();
 			_data_SW.switchTest[_currentTest_SW].switchtime = switchTime;
 			logger.log(LogLevel::SUCCESS, "Processing successful");
 			return true;
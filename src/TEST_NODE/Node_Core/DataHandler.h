@@ -6,37 +6,148 @@
 #include "Settings.h"
 #include "Logger.h"
 #include "TestSync.h"
+#include "ModbusStats.hpp"
 
 #include <array>
+#include <atomic>
+#include <map>
 #include <set>
+#include <string>
+#include <vector>
 #include "wsDefines.hpp"
+#include "wsCommandTable.hpp"
+#include "wsFrame.hpp"
+#include "telemetryEncode.hpp"
+#include "telemetryHistory.hpp"
+#include "report.pb.h"
 
 namespace Node_Core
 {
 static constexpr size_t WS_BUFFER_SIZE = 256;
 static constexpr size_t WS_QUEUE_SIZE = 20;
+static constexpr size_t WS_SLOT_SIZE = 32;
 static constexpr TickType_t QUEUE_TIMEOUT_MS = pdMS_TO_TICKS(300);
 static constexpr TickType_t DATABIT_TIMEOUT_MS = pdMS_TO_TICKS(200);
 static constexpr TickType_t CLIENT_CONNECT_TIMEOUT_MS = pdMS_TO_TICKS(1000);
 static constexpr TickType_t READ_TIMEOUT_MS = pdMS_TO_TICKS(2000);
 
+// Readings go out as the meters publish them rather than on a fixed tick. A client gets at most
+// one frame per MIN_INTERVAL; snapshots arriving sooner collapse into one trailing frame with the
+// latest values. Without fresh readings a frame still goes out every HEARTBEAT.
+static constexpr uint32_t TELEMETRY_MIN_INTERVAL_MS = 100;
+static constexpr uint32_t TELEMETRY_HEARTBEAT_MS = 1000;
+// Send-queue backpressure. Readings are queued only while a client has fewer than QUEUE_LIMIT
+// messages waiting, which keeps the rest of WS_MAX_QUEUED_MESSAGES free for command replies; a
+// readings frame meeting a longer queue is dropped, as the next one supersedes it. SLOW_AFTER
+// drops in a row move the client to one frame per SLOW_INTERVAL, on full frames if it was on
+// delta, until RECOVER_AFTER frames find its queue empty.
+static constexpr size_t TELEMETRY_QUEUE_LIMIT = 4;
+static constexpr uint8_t TELEMETRY_SLOW_AFTER = 3;
+static constexpr uint8_t TELEMETRY_RECOVER_AFTER = 10;
+static constexpr uint32_t TELEMETRY_SLOW_INTERVAL_MS = 1000;
+// Task notification bits, clear of the UserUpdateEvent bits: a fresh snapshot, and a message
+// waiting in WebsocketDataQueue
+static constexpr uint32_t READINGS_READY_NOTIFY = 1UL << 16;
+static constexpr uint32_t WS_MESSAGE_NOTIFY = 1UL << 17;
+
+// User commands go from the WebSocket event straight to the command task. The issuer gets an ACK
+// once the command is queued and a DONE once the state machine has run it; "start#17" tags
+// both with request id 17. Receipt to dispatch should stay inside the budget.
+static constexpr uint32_t COMMAND_LATENCY_BUDGET_MS = 50;
+// History catch-up. A client gets one chunk of at most CHUNK_SAMPLES buckets at a time, and only
+// while fewer than QUEUE_LIMIT messages wait in its queue; readings are admitted up to
+// TELEMETRY_QUEUE_LIMIT, so the live feed always finds room. The data task comes back every
+// CHUNK_INTERVAL while a catch-up is running.
+static constexpr size_t HISTORY_CHUNK_SAMPLES = 20;
+static constexpr size_t HISTORY_QUEUE_LIMIT = 2;
+static constexpr uint32_t HISTORY_CHUNK_INTERVAL_MS = 20;
+static constexpr size_t HISTORY_CHUNK_BYTES = 4096;
+// Server-Sent Events on /events for read-only viewers: the JSON readings frame under event
+// "readings", on one shared throttle. Each event id is a sequence number and the last few frames
+// are kept, so a browser reconnecting with Last-Event-ID gets what it missed.
+static constexpr size_t SSE_REPLAY_EVENTS = 8;
+static constexpr uint32_t SSE_RETRY_MS = 2000;
+
+// Snapshot of the command path counters, see DataHandler::commandStats()
+struct CommandStats
+{
+	uint32_t accepted = 0;
+	uint32_t rejected = 0; // Command queue full or command not supported
+	uint32_t completed = 0;
+	uint32_t overBudget = 0; // Dispatched later than COMMAND_LATENCY_BUDGET_MS after receipt
+	uint32_t lastDispatch_us = 0; // Receipt to the command task picking it up
+	uint32_t lastTotal_us = 0; // Receipt to DONE
+	Node_Utility::RttHistogram dispatch;
+	Node_Utility::RttHistogram total;
+};
+
+// Cost of the readings frame in one encoding, measured at every broadcast
+struct FrameStats
+{
+	uint32_t frames = 0;
+	uint32_t lastBytes = 0;
+	uint32_t lastEncode_us = 0;
+	uint64_t totalBytes = 0;
+	uint64_t totalEncode_us = 0;
+};
+
+// Send-queue accounting for one client, reported on /ws/stats
+struct ClientQueueStats
+{
+	int clientId = 0;
+	TelemetryFormat format = TelemetryFormat::JSON;
+	bool slow = false; // Downgraded to TELEMETRY_SLOW_INTERVAL_MS
+	uint32_t sent = 0; // Readings frames queued
+	uint32_t dropped = 0; // Readings frames skipped on a backed-up queue
+	uint32_t downgrades = 0;
+	uint16_t queueLen = 0; // As seen by the last readings frame
+	uint16_t queuePeak = 0;
+};
+
+// A history request being answered; from_ms moves forward one chunk at a time
+struct HistoryCursor
+{
+	uint32_t from_ms = 0;
+	uint32_t to_ms = 0;
+	uint32_t step_ms = HISTORY_SAMPLE_MS;
+	uint32_t requestId = 0;
+	uint16_t chunk = 0;
+};
+
+// Per-client throttle; pending means the client has not yet seen the latest snapshot
+struct PushState
+{
+	uint32_t sent_ms = 0;
+	bool pending = true;
+	bool due = false;
+	uint8_t congested = 0; // Readings frames dropped in a row
+	uint8_t drained = 0; // Readings frames in a row that found the queue empty
+	bool keyFrame = false; // Delta client owed a key frame of its own before the next delta
+	ClientQueueStats stats;
+};
+
 struct WsDataHandlerTaskParams
 {
 	AsyncWebSocket* ws;
+	AsyncEventSource* events;
 };
 
-struct WebSocketMessage
+// A readings frame kept for Last-Event-ID resume; shares the buffer the clients were sent
+struct SseReplay
 {
-	uint8_t data[WS_BUFFER_SIZE];
-	size_t len;
-	AwsFrameInfo info;
-	int client_id;
-	AsyncWebSocketClient* client;
+	uint32_t id = 0;
+	AsyncWebSocketSharedBuffer frame;
+};
 
-	WebSocketMessage() : len(0), info(), client_id(0), client(nullptr)
-	{
-		memset(data, 0, sizeof(data));
-	}
+// Messages for the data task wait in WS_QUEUE_SIZE fixed slots and WebsocketDataQueue carries
+// slot indices, so posting copies the text once and the queue copies one byte. Only the short
+// format and readings commands take this path; user commands are dispatched on arrival.
+struct WebSocketMessage
+{
+	char data[WS_SLOT_SIZE]; // NUL-terminated
+	uint8_t len = 0;
+	int client_id = 0;
+	AsyncWebSocketClient* client = nullptr;
 };
 
 class DataHandler
@@ -57,15 +168,60 @@ class DataHandler
 
 	// Client Management
 	void updateClientList(int clientId, bool connected);
+	// Clients start on JSON and opt in with "format:pb" or "format:delta"
+	void setClientFormat(int clientId, TelemetryFormat format);
 
 	// Data Handling
 	void sendData(AsyncWebSocket* websocket, int clientId,
 				  wsOutGoingDataType type = wsOutGoingDataType::POWER_READINGS);
 	void sendData(AsyncWebSocketClient* client,
 				  wsOutGoingDataType type = wsOutGoingDataType::LED_STATUS);
-	void processWsMessage(WebSocketMessage& wsMsg);
-	void handleWsIncomingCommands(wsIncomingCommands cmd);
-	void handleUserCommand(UserCommandEvent command);
+	// Serializes once and queues the same buffer on every connected client. Readings only go
+	// to clients whose throttle allows it; fresh marks a new snapshot for everyone.
+	void broadcastData(AsyncWebSocket* websocket, wsOutGoingDataType type, bool fresh = true);
+	// Time until some client is owed a readings frame, at most TELEMETRY_HEARTBEAT_MS
+	TickType_t nextPushDelay();
+	std::vector<ClientQueueStats> clientStats();
+	// Copies the text into a free slot and wakes the data task; false when none is free or the
+	// text does not fit
+	bool postWsMessage(AsyncWebSocketClient* client, const char* data, size_t len);
+	void processWsMessage(const WebSocketMessage& wsMsg);
+	const FrameStats& jsonStats() const
+	{
+		return _jsonStats;
+	}
+	const FrameStats& binaryStats() const
+	{
+		return _binaryStats;
+	}
+	const FrameStats& deltaStats() const
+	{
+		return _deltaStats;
+	}
+	// Readings fan-out per transport: bytes handed over to all clients and time spent doing it
+	const FrameStats& wsFanoutStats() const
+	{
+		return _wsFanoutStats;
+	}
+	const FrameStats& sseFanoutStats() const
+	{
+		return _sseFanoutStats;
+	}
+	size_t sseClients() const;
+	// Runs on the async_tcp task when a browser opens /events
+	void replaySse(AsyncEventSourceClient* client);
+	// Called from the WebSocket event; false leaves the message to the data task
+	bool dispatchCommand(AsyncWebSocketClient* client, const char* data, size_t len);
+	// Runs in the command task once the command has been carried out
+	void completeCommand(const CommandRequest& request, uint32_t dispatched_us);
+	CommandStats commandStats() const;
+	// "history[:from[,to[,step]]][#id]", times in ms of the node clock as in the readings
+	// frames; to 0 means now and step 0 the stored resolution. False if data is not one.
+	bool requestHistory(AsyncWebSocketClient* client, const char* data, size_t len);
+	// Sends the chunks that fit; true while a catch-up is still running
+	bool serveHistory(AsyncWebSocket* websocket);
+	bool handleWsIncomingCommands(wsIncomingCommands cmd, CommandRequest& request);
+	bool handleUserCommand(const CommandRequest& request);
 	// Task Handles
 	TaskHandle_t dataTaskHandler = NULL;
 	// Queues
@@ -79,10 +235,45 @@ class DataHandler
 	DataHandler& operator=(const DataHandler&) = delete;
 
 	// WebSocket Utilities
-	wsIncomingCommands getWebSocketCommand(const char* incomingCommand);
 	JsonDocument prepData(wsOutGoingDataType type);
+	AsyncWebSocketSharedBuffer serializeFrame(const JsonDocument& doc,
+											  size_t limit = WS_BUFFER_SIZE);
+	void sendFrame(AsyncWebSocket* websocket, int clientId, AsyncWebSocketSharedBuffer frame);
+	void replyCommand(AsyncWebSocketClient* client, const char* type, const char* name,
+					  uint32_t requestId, const char* reason = nullptr);
+	void fillTelemetry(pg_TelemetryFrame& frame);
+	AsyncWebSocketSharedBuffer encodeTelemetry();
+	AsyncWebSocketSharedBuffer encodeDeltaTelemetry();
+	AsyncWebSocketSharedBuffer encodeDeltaKeyFrame();
+	AsyncWebSocketSharedBuffer encodeFrame(const pg_TelemetryFrame& frame);
+	TelemetryFormat formatOf(int clientId) const;
+	PushState& laneFor(int clientId, TelemetryFormat format);
+	static uint32_t laneInterval(const PushState& push);
+	static void markDue(PushState& push, uint32_t now, bool fresh, uint32_t interval_ms);
+	bool admitTelemetry(AsyncWebSocketClient* client, PushState& push, TelemetryFormat format);
+	static void recordFrame(FrameStats& stats, size_t bytes, uint32_t encode_us);
+	void recordHistory();
+	void publishSse(const AsyncWebSocketSharedBuffer& frame);
+	bool sendHistoryChunk(AsyncWebSocketClient* client, HistoryCursor& cursor);
 	void cleanUpClients(AsyncWebSocket* websocket);
-	bool isValidUTF8(const char* data, size_t len);
+
+	// Message slots; freeSlotQueue holds the indices not in use
+	std::array<WebSocketMessage, WS_QUEUE_SIZE> _wsSlots;
+	QueueHandle_t freeSlotQueue = NULL;
+
+	// Commands
+	std::atomic<AsyncWebSocket*> _websocket{nullptr}; // For replies from the command task
+	// Counted from async_tcp (accepted, rejected) and the command task (the rest); the
+	// histograms are not atomic and stay under commandStatsMutex
+	std::atomic<uint32_t> _commandsAccepted{0};
+	std::atomic<uint32_t> _commandsRejected{0};
+	std::atomic<uint32_t> _commandsCompleted{0};
+	std::atomic<uint32_t> _commandsOverBudget{0};
+	std::atomic<uint32_t> _lastDispatch_us{0};
+	std::atomic<uint32_t> _lastTotal_us{0};
+	Node_Utility::RttHistogram _dispatchLatency;
+	Node_Utility::RttHistogram _totalLatency;
+	SemaphoreHandle_t commandStatsMutex;
 
 	// Synchronization Primitives
 	SemaphoreHandle_t websocketMutex;
@@ -90,6 +281,32 @@ class DataHandler
 
 	// Client Management
 	std::set<int> connectedClients;
+	std::map<int, TelemetryFormat> binaryClients; // Clients of connectedClients not on JSON
+	std::map<int, PushState> _push;
+	PushState _deltaPush; // Delta clients share one stream, so they share one throttle
+	std::map<int, HistoryCursor> _historyCursors;
+
+	// Recent readings and state changes for clients catching up
+	TelemetryHistory _history;
+
+	// Binary readings; the frame lives here rather than on the task stack
+	pg_TelemetryFrame _telemetryFrame = pg_TelemetryFrame_init_zero;
+	uint32_t _telemetrySequence = 0;
+	FrameStats _jsonStats;
+	FrameStats _binaryStats;
+
+	DeltaTelemetry _delta;
+	FrameStats _deltaStats;
+
+	// Server-Sent Events; the replay ring is guarded by sseMutex, never held across a send
+	std::atomic<AsyncEventSource*> _events{nullptr};
+	PushState _ssePush;
+	uint32_t _sseSequence = 0;
+	std::array<SseReplay, SSE_REPLAY_EVENTS> _sseReplay;
+	std::string _sseText; // data task only
+	SemaphoreHandle_t sseMutex;
+	FrameStats _wsFanoutStats;
+	FrameStats _sseFanoutStats;
 
 	// Flags
 	bool _updateLedStatus = false;
@@ -2,6 +2,7 @@
 #include "HPTSettings.h"
 #include "PZEM_Modbus.hpp"
 #include "NodeUtility.hpp"
+#include <algorithm>
 
 using namespace Node_Core;
 using namespace Node_Utility;
@@ -21,17 +22,31 @@ DataHandler::DataHandler() :
 	_periodicSendRequest(false), _result(ProcessingResult::PENDING),
 	_currentState(State::DEVICE_ON), _deviceMode(TestMode::MANUAL), _newClietId(0)
 {
-	WebsocketDataQueue = xQueueCreate(WS_QUEUE_SIZE, sizeof(WebSocketMessage));
+	static_assert(WS_QUEUE_SIZE <= UINT8_MAX, "Slot indices travel as uint8_t");
+	WebsocketDataQueue = xQueueCreate(WS_QUEUE_SIZE, sizeof(uint8_t));
+	freeSlotQueue = xQueueCreate(WS_QUEUE_SIZE, sizeof(uint8_t));
+	for(uint8_t slot = 0; slot < WS_QUEUE_SIZE; ++slot)
+	{
+		xQueueSend(freeSlotQueue, &slot, 0);
+	}
 	websocketMutex = xSemaphoreCreateMutex();
 	clientListMutex = xSemaphoreCreateMutex();
+	sseMutex = xSemaphoreCreateMutex();
+	commandStatsMutex = xSemaphoreCreateMutex();
 }
 void DataHandler::updateState(State state)
 {
-	_currentState.store(state);
+	if(_currentState.exchange(state) != state)
+	{
+		_history.recordEvent(millis(), false, static_cast<uint8_t>(state));
+	}
 }
 void DataHandler::updateMode(TestMode mode)
 {
-	_deviceMode.store(mode);
+	if(_deviceMode.exchange(mode) != mode)
+	{
+		_history.recordEvent(millis(), true, static_cast<uint8_t>(mode));
+	}
 }
 void DataHandler::updateNewClientId(int Id)
 {
@@ -42,9 +57,11 @@ void DataHandler::wsDataHandler(void* pvParameter)
 	WsDataHandlerTaskParams* params = static_cast<WsDataHandlerTaskParams*>(pvParameter);
 	DataHandler& instance = DataHandler::getInstance();
 	AsyncWebSocket* websocket = params->ws;
-	TickType_t lastWakeTime = xTaskGetTickCount();
-	WebSocketMessage wsMsg;
+	uint8_t slot;
 	uint32_t ulNotificationValue;
+	TickType_t wait = pdMS_TO_TICKS(TELEMETRY_HEARTBEAT_MS);
+	instance._websocket = websocket;
+	instance._events = params->events;
 
 	while(true)
 	{
@@ -54,66 +71,56 @@ void DataHandler::wsDataHandler(void* pvParameter)
 		{
 			logger.log(LogLevel::INTR, "DATA Bit is set,,,processing WebSocket data");
 
-			while(uxQueueMessagesWaiting(instance.WebsocketDataQueue) > 0)
+			while(xQueueReceive(instance.WebsocketDataQueue, &slot, 0) == pdTRUE)
 			{
-				if(xQueueReceive(instance.WebsocketDataQueue, &wsMsg, QUEUE_TIMEOUT_MS))
-				{
-					logger.log(LogLevel::INFO, "Processing WebSocket data in combined task");
-					instance.processWsMessage(wsMsg);
-				}
-				else
-				{
-					logger.log(LogLevel::ERROR, "Queue timeout while processing WebSocket data!");
-				}
+				logger.log(LogLevel::INFO, "Processing WebSocket data in combined task");
+				instance.processWsMessage(instance._wsSlots[slot]);
+				xQueueSend(instance.freeSlotQueue, &slot, 0);
 			}
 		}
 
-		// Handle Periodic Data Sending
-		if(xEventGroupWaitBits(EventHelper::wsClientEventGroup,
+		// Sleep until the meters publish, an event arrives or a client is owed a frame
+		ulNotificationValue = 0;
+		xTaskNotifyWait(0x00, 0xFFFFFFFF, &ulNotificationValue, wait);
+		bool fresh = (ulNotificationValue & READINGS_READY_NOTIFY) != 0;
+		if(fresh)
+		{
+			instance.recordHistory();
+		}
+
+		// Handle Data Sending
+		// SSE viewers never send getReadings; having one open is the request
+		wait = pdMS_TO_TICKS(TELEMETRY_HEARTBEAT_MS);
+		if(instance.sseClients() > 0 ||
+		   xEventGroupWaitBits(EventHelper::wsClientEventGroup,
 							   static_cast<EventBits_t>(wsClientUpdate::GET_READING), pdFALSE,
 							   pdFALSE, 0))
 		{
-			std::set<int> clientsToCheck = instance.connectedClients;
-			for(int clientId: clientsToCheck)
-			{
-				AsyncWebSocketClient* client = websocket->client(clientId);
-				if(client != nullptr && client->status() == WS_CONNECTED)
-				{
-					instance.sendData(websocket, clientId);
-				}
-				else
-				{
-					logger.log(LogLevel::ERROR,
-							   "Client object for ID %d is nullptr or disconnected", clientId);
-					instance.updateClientList(clientId, false);
-				}
-			}
+			instance.broadcastData(websocket, wsOutGoingDataType::POWER_READINGS, fresh);
+			wait = instance.nextPushDelay();
+		}
+		if(instance.serveHistory(websocket))
+		{
+			wait = std::min(wait, pdMS_TO_TICKS(HISTORY_CHUNK_INTERVAL_MS));
 		}
 
 		// Handle Task Notifications
-		if(xTaskNotifyWait(0x00, 0xFFFFFFFF, &ulNotificationValue, 0) == pdTRUE)
+		uint32_t events = ulNotificationValue & ~(READINGS_READY_NOTIFY | WS_MESSAGE_NOTIFY);
+		if(events & static_cast<uint32_t>(UserUpdateEvent::NEW_TEST))
 		{
-			switch(static_cast<UserUpdateEvent>(ulNotificationValue))
-			{
-				case UserUpdateEvent::NEW_TEST:
-					logger.log(LogLevel::SUCCESS, "Sending LED STATUS from combined task");
-					for(int clientId: instance.connectedClients)
-					{
-						instance.sendData(websocket, clientId, wsOutGoingDataType::LED_STATUS);
-					}
-					break;
-				case UserUpdateEvent::DELETE_TEST:
-					// Add logic for DELETE_TEST event
-					break;
-				default:
-					logger.log(LogLevel::INFO, "Unhandled notification event: %d",
-							   ulNotificationValue);
-					break;
-			}
+			logger.log(LogLevel::SUCCESS, "Sending LED STATUS from combined task");
+			instance.broadcastData(websocket, wsOutGoingDataType::LED_STATUS);
+		}
+		if(events & static_cast<uint32_t>(UserUpdateEvent::DELETE_TEST))
+		{
+			// Add logic for DELETE_TEST event
+		}
+		events &= ~static_cast<uint32_t>(UserUpdateEvent::NEW_TEST) &
+				  ~static_cast<uint32_t>(UserUpdateEvent::DELETE_TEST);
+		if(events != 0)
+		{
+			logger.log(LogLevel::INFO, "Unhandled notification event: %d", events);
 		}
-
-		// Maintain periodic delay
-		vTaskDelayUntil(&lastWakeTime, 1000 / portTICK_PERIOD_MS);
 	}
 
 	vTaskDelete(NULL);
@@ -136,41 +143,103 @@ void DataHandler::updateClientList(int clientId, bool connected)
 		else
 		{
 			connectedClients.erase(clientId);
+			binaryClients.erase(clientId);
+			_push.erase(clientId);
+			_historyCursors.erase(clientId);
 		}
 		xSemaphoreGive(clientListMutex);
 	}
 }
 
-void DataHandler::processWsMessage(WebSocketMessage& wsMsg)
+void DataHandler::setClientFormat(int clientId, TelemetryFormat format)
 {
-	char message[WS_BUFFER_SIZE];
+	if(xSemaphoreTake(clientListMutex, portMAX_DELAY) == pdTRUE)
+	{
+		if(format == TelemetryFormat::JSON)
+		{
+			binaryClients.erase(clientId);
+		}
+		else
+		{
+			binaryClients[clientId] = format;
+		}
+		// A new delta client has no baseline yet
+		if(format == TelemetryFormat::DELTA && connectedClients.count(clientId) > 0)
+		{
+			_push[clientId].keyFrame = true;
+		}
+		xSemaphoreGive(clientListMutex);
+	}
+}
 
-	if(wsMsg.len >= sizeof(message))
+bool DataHandler::postWsMessage(AsyncWebSocketClient* client, const char* data, size_t len)
+{
+	uint8_t slot;
+	if(len >= WS_SLOT_SIZE || xQueueReceive(freeSlotQueue, &slot, 0) != pdTRUE)
 	{
-		Serial.println("Received data exceeds MAX BUFFER SIZE");
-		return;
+		return false;
 	}
 
-	memcpy(message, wsMsg.data, wsMsg.len);
-	message[wsMsg.len] = '\0';
+	WebSocketMessage& wsMsg = _wsSlots[slot];
+	memcpy(wsMsg.data, data, len);
+	wsMsg.data[len] = '\0';
+	wsMsg.len = static_cast<uint8_t>(len);
+	wsMsg.client_id = client->id();
+	wsMsg.client = client;
+	if(xQueueSend(WebsocketDataQueue, &slot, 0) != pdTRUE)
+	{
+		xQueueSend(freeSlotQueue, &slot, 0);
+		return false;
+	}
 
-	wsIncomingCommands cmd = getWebSocketCommand(message);
-	logger.log(LogLevel::INFO, "processing Message: %s", message);
+	if(dataTaskHandler != NULL)
+	{
+		xTaskNotify(dataTaskHandler, WS_MESSAGE_NOTIFY, eSetBits);
+	}
+	return true;
+}
 
-	if(cmd != wsIncomingCommands::INVALID_COMMAND && cmd != wsIncomingCommands::GET_READINGS)
+void DataHandler::processWsMessage(const WebSocketMessage& wsMsg)
+{
+	const WsCommandName* command = findWsCommand(wsMsg.data, wsMsg.len);
+	wsIncomingCommands cmd = wsIncomingCommands::INVALID_COMMAND;
+	if(command != nullptr)
 	{
-		handleWsIncomingCommands(cmd);
+		cmd = command->cmd;
+	}
+	logger.log(LogLevel::INFO, "processing Message: %s", wsMsg.data);
 
-		AsyncWebSocketClient* client = wsMsg.client;
-		if(client == nullptr || (client->status() != AwsClientStatus::WS_CONNECTED))
+	if(cmd == wsIncomingCommands::FORMAT_BINARY || cmd == wsIncomingCommands::FORMAT_DELTA ||
+	   cmd == wsIncomingCommands::FORMAT_JSON)
+	{
+		TelemetryFormat format = TelemetryFormat::JSON;
+		const char* ack = R"({"type":"format","format":"json"})";
+		if(cmd == wsIncomingCommands::FORMAT_BINARY)
 		{
-			logger.log(LogLevel::ERROR,
-					   " not connected or is null, aborting from processMsg function.");
+			format = TelemetryFormat::BINARY;
+			ack = R"({"type":"format","format":"pb"})";
 		}
-		else
+		else if(cmd == wsIncomingCommands::FORMAT_DELTA)
 		{
-			sendData(client);
+			format = TelemetryFormat::DELTA;
+			ack = R"({"type":"format","format":"delta"})";
 		}
+		setClientFormat(wsMsg.client_id, format);
+
+		// By id and under websocketMutex: the queued client pointer may be gone by now
+		const uint8_t* text = reinterpret_cast<const uint8_t*>(ack);
+		sendFrame(_websocket.load(), wsMsg.client_id,
+				  std::make_shared<std::vector<uint8_t>>(text, text + strlen(ack)));
+	}
+	else if(cmd == wsIncomingCommands::TELEMETRY_RESYNC)
+	{
+		logger.log(LogLevel::INFO, "Client %d requested a telemetry resync", wsMsg.client_id);
+		xSemaphoreTake(clientListMutex, portMAX_DELAY);
+		if(connectedClients.count(wsMsg.client_id) > 0)
+		{
+			_push[wsMsg.client_id].keyFrame = true;
+		}
+		xSemaphoreGive(clientListMutex);
 	}
 	else if(cmd == wsIncomingCommands::GET_READINGS)
 	{
@@ -180,75 +249,574 @@ void DataHandler::processWsMessage(WebSocketMessage& wsMsg)
 
 void DataHandler::sendData(AsyncWebSocket* websocket, int clientId, wsOutGoingDataType type)
 {
-	JsonDocument doc;
+	sendFrame(websocket, clientId, serializeFrame(prepData(type)));
+}
 
-	// Prepare JSON data
-	if(type == wsOutGoingDataType::POWER_READINGS)
+void DataHandler::sendFrame(AsyncWebSocket* websocket, int clientId,
+							AsyncWebSocketSharedBuffer frame)
+{
+	if(!frame || websocket == nullptr)
 	{
-		doc = prepData(wsOutGoingDataType::POWER_READINGS);
+		return;
 	}
-	else if(type == wsOutGoingDataType::LED_STATUS)
-	{
-		logger.log(LogLevel::INTR, "CURRENT  STATE FOR LED %s ",
-				   Node_Utility::ToString::state(_currentState));
 
-		if(_currentState == State::READY_TO_PROCEED)
+	if(xSemaphoreTake(websocketMutex, portMAX_DELAY) == pdTRUE)
+	{
+		AsyncWebSocketClient* client = websocket->client(clientId);
+		if(client == nullptr || (client->status() != AwsClientStatus::WS_CONNECTED))
 		{
-			_blinkGreen = true;
+			logger.log(LogLevel::ERROR, "Client is not connected or is null, aborting send.");
 		}
-
-		doc["type"] = "LED_STATUS";
-		doc["blinkBlue"] = _blinkBlue;
-		doc["blinkGreen"] = _blinkGreen;
-		doc["blinkRed"] = _blinkRed;
+		else
+		{
+			client->text(frame);
+			logger.log(LogLevel::SUCCESS, "Data sent successfully to client %d.", clientId);
+		}
+		xSemaphoreGive(websocketMutex); // Ensure the mutex is released
 	}
 	else
 	{
-		logger.log(LogLevel::ERROR, "Not implemented yet");
-		return;
+		logger.log(LogLevel::ERROR, "Failed to take WebSocket mutex.");
 	}
+}
 
-	std::array<char, WS_BUFFER_SIZE> jsonBuffer;
-	size_t len = serializeJson(doc, jsonBuffer.data(), jsonBuffer.size());
+void DataHandler::broadcastData(AsyncWebSocket* websocket, wsOutGoingDataType type, bool fresh)
+{
+	// Only readings have a binary form, a throttle or a drop policy; LED status and the like
+	// stay JSON and go to everyone at once
+	bool binaryType = type == wsOutGoingDataType::POWER_READINGS;
+	uint32_t now = millis();
+	bool anyJson = !binaryType;
+	bool anyBinary = false;
+	bool anyDelta = false;
+	bool anyDeltaKey = false;
+	bool anyDue = false;
+	bool sseDue = false;
+	size_t sseViewers = binaryType ? sseClients() : 0;
+	xSemaphoreTake(clientListMutex, portMAX_DELAY);
+	if(binaryType && sseViewers > 0)
+	{
+		markDue(_ssePush, now, fresh, TELEMETRY_MIN_INTERVAL_MS);
+		sseDue = _ssePush.due;
+		anyJson = anyJson || sseDue;
+		anyDue = anyDue || sseDue;
+	}
+	if(binaryType)
+	{
+		bool deltaMarked = false;
+		for(int clientId: connectedClients)
+		{
+			TelemetryFormat format = formatOf(clientId);
+			PushState& push = laneFor(clientId, format);
+			if(&push != &_deltaPush || !deltaMarked)
+				markDue(push, now, fresh, laneInterval(push));
+			deltaMarked = deltaMarked || &push == &_deltaPush;
+			if(!push.due)
+				continue;
+			anyDue = true;
+			if(&push == &_deltaPush)
+			{
+				anyDelta = true;
+				anyDeltaKey = anyDeltaKey || _push[clientId].keyFrame;
+			}
+			else if(format == TelemetryFormat::JSON)
+				anyJson = true;
+			else
+				anyBinary = true;
+		}
+	}
+	xSemaphoreGive(clientListMutex);
 
-	if(len == 0)
+	// One encoding per format, each shared by every client that asked for it
+	AsyncWebSocketSharedBuffer json;
+	AsyncWebSocketSharedBuffer binary;
+	AsyncWebSocketSharedBuffer delta;
+	AsyncWebSocketSharedBuffer deltaKey;
+	if(anyJson)
 	{
-		logger.log(LogLevel::ERROR, "Serialization failed: Empty JSON.");
-		return;
+		uint32_t started = micros();
+		json = serializeFrame(prepData(type));
+		if(json && binaryType)
+			recordFrame(_jsonStats, json->size(), micros() - started);
 	}
-	else if(len >= jsonBuffer.size())
+	if(anyBinary)
 	{
-		logger.log(LogLevel::ERROR, "Serialization failed: Buffer overflow.");
-		return;
+		uint32_t started = micros();
+		binary = encodeTelemetry();
+		if(binary)
+			recordFrame(_binaryStats, binary->size(), micros() - started);
 	}
-	else if(!isValidUTF8(jsonBuffer.data(), len))
+	if(anyDelta)
+	{
+		uint32_t started = micros();
+		delta = encodeDeltaTelemetry();
+		if(delta)
+			recordFrame(_deltaStats, delta->size(), micros() - started);
+		if(delta && anyDeltaKey)
+			deltaKey = encodeDeltaKeyFrame();
+	}
+	// Due clients whose frame failed still go through the loop to have their throttle reset
+	if(!json && !anyDue)
 	{
-		logger.log(LogLevel::ERROR, "Invalid UTF-8 data detected.");
 		return;
 	}
 
 	if(xSemaphoreTake(websocketMutex, portMAX_DELAY) == pdTRUE)
 	{
-		AsyncWebSocketClient* client = websocket->client(clientId);
-		if(client == nullptr || (client->status() != AwsClientStatus::WS_CONNECTED))
+		uint32_t fanoutStarted = micros();
+		size_t fanoutBytes = 0;
+		xSemaphoreTake(clientListMutex, portMAX_DELAY);
+		for(auto it = connectedClients.begin(); it != connectedClients.end();)
 		{
-			logger.log(LogLevel::ERROR, "Client is not connected or is null, aborting send.");
+			AsyncWebSocketClient* client = websocket->client(*it);
+			if(client == nullptr || client->status() != WS_CONNECTED)
+			{
+				logger.log(LogLevel::ERROR,
+						   "Client object for ID %d is nullptr or disconnected", *it);
+				binaryClients.erase(*it);
+				_push.erase(*it);
+				it = connectedClients.erase(it);
+				continue;
+			}
+			if(!binaryType)
+			{
+				client->text(json);
+				++it;
+				continue;
+			}
+
+			// A client that is not due keeps its pending flag and gets the trailing frame
+			TelemetryFormat format = formatOf(*it);
+			PushState& push = laneFor(*it, format);
+			if(!push.due)
+			{
+				++it;
+				continue;
+			}
+			// Only the delta client that lost track gets the key frame; the rest stay on the
+			// shared stream and its baseline
+			PushState& own = _push[*it];
+			bool keyFrame = &push == &_deltaPush && own.keyFrame && deltaKey;
+			AsyncWebSocketSharedBuffer frame = binary;
+			if(keyFrame)
+				frame = deltaKey;
+			else if(&push == &_deltaPush)
+				frame = delta;
+			else if(format == TelemetryFormat::JSON)
+				frame = json;
+			if(frame && admitTelemetry(client, own, format))
+			{
+				if(keyFrame)
+					own.keyFrame = false;
+				if(format == TelemetryFormat::JSON)
+					client->text(frame);
+				else
+					client->binary(frame);
+				fanoutBytes += frame->size();
+			}
+			// Counted as served even if the frame failed to build or was dropped, so it is
+			// retried on the next snapshot or heartbeat rather than in a tight loop
+			if(&push != &_deltaPush)
+			{
+				push.sent_ms = now;
+				push.pending = false;
+				push.due = false;
+			}
+			++it;
 		}
-		else if(client->status() == WS_CONNECTED)
+		if(binaryType && _deltaPush.due)
 		{
-			websocket->text(clientId, jsonBuffer.data());
-			logger.log(LogLevel::SUCCESS, "Data sent successfully to client %d.", clientId);
+			_deltaPush.sent_ms = now;
+			_deltaPush.pending = false;
+			_deltaPush.due = false;
 		}
-		else
+		if(sseDue)
 		{
-			logger.log(LogLevel::ERROR, "Client %d is no longer connected.", clientId);
+			_ssePush.sent_ms = now;
+			_ssePush.pending = false;
+			_ssePush.due = false;
 		}
-		xSemaphoreGive(websocketMutex); // Ensure the mutex is released
+		xSemaphoreGive(clientListMutex);
+		xSemaphoreGive(websocketMutex);
+		if(fanoutBytes > 0)
+			recordFrame(_wsFanoutStats, fanoutBytes, micros() - fanoutStarted);
 	}
 	else
 	{
 		logger.log(LogLevel::ERROR, "Failed to take WebSocket mutex.");
 	}
+
+	if(sseDue && json)
+	{
+		publishSse(json);
+	}
+}
+
+// Callers of the helpers below hold clientListMutex
+TelemetryFormat DataHandler::formatOf(int clientId) const
+{
+	auto format = binaryClients.find(clientId);
+	return format != binaryClients.end() ? format->second : TelemetryFormat::JSON;
+}
+
+PushState& DataHandler::laneFor(int clientId, TelemetryFormat format)
+{
+	PushState& push = _push[clientId];
+	if(format == TelemetryFormat::DELTA && !push.stats.slow)
+	{
+		return _deltaPush;
+	}
+	return push;
+}
+
+uint32_t DataHandler::laneInterval(const PushState& push)
+{
+	return push.stats.slow ? TELEMETRY_SLOW_INTERVAL_MS : TELEMETRY_MIN_INTERVAL_MS;
+}
+
+void DataHandler::markDue(PushState& push, uint32_t now, bool fresh, uint32_t interval_ms)
+{
+	uint32_t elapsed = now - push.sent_ms;
+	push.pending = push.pending || fresh || elapsed >= TELEMETRY_HEARTBEAT_MS;
+	push.due = push.pending && elapsed >= interval_ms;
+}
+
+bool DataHandler::admitTelemetry(AsyncWebSocketClient* client, PushState& push,
+								 TelemetryFormat format)
+{
+	ClientQueueStats& stats = push.stats;
+	size_t queued = client->queueLen();
+	stats.queueLen = static_cast<uint16_t>(queued);
+	stats.queuePeak = std::max(stats.queuePeak, stats.queueLen);
+
+	if(queued >= TELEMETRY_QUEUE_LIMIT || !client->canSend())
+	{
+		stats.dropped++;
+		push.drained = 0;
+		// It will miss this delta; the next frame it gets has to stand on its own
+		if(format == TelemetryFormat::DELTA)
+			push.keyFrame = true;
+		if(++push.congested >= TELEMETRY_SLOW_AFTER && !stats.slow)
+		{
+			stats.slow = true;
+			stats.downgrades++;
+			logger.log(LogLevel::WARNING, "Client %d is backed up (%u queued), slowing readings",
+					   client->id(), static_cast<unsigned>(queued));
+		}
+		return false;
+	}
+
+	push.congested = 0;
+	push.drained = queued == 0 ? push.drained + 1 : 0;
+	if(stats.slow && push.drained >= TELEMETRY_RECOVER_AFTER)
+	{
+		stats.slow = false;
+		push.drained = 0;
+		// Back on the shared delta stream, which it has not been following
+		if(format == TelemetryFormat::DELTA)
+			push.keyFrame = true;
+		logger.log(LogLevel::INFO, "Client %d caught up, readings back to full rate",
+				   client->id());
+	}
+	stats.sent++;
+	return true;
+}
+
+TickType_t DataHandler::nextPushDelay()
+{
+	uint32_t now = millis();
+	uint32_t wait = TELEMETRY_HEARTBEAT_MS;
+	bool deltaOwed = false;
+	bool sseOwed = sseClients() > 0;
+
+	xSemaphoreTake(clientListMutex, portMAX_DELAY);
+	if(sseOwed)
+	{
+		uint32_t elapsed = now - _ssePush.sent_ms;
+		uint32_t limit = _ssePush.pending ? TELEMETRY_MIN_INTERVAL_MS : TELEMETRY_HEARTBEAT_MS;
+		wait = elapsed >= limit ? 0 : limit - elapsed;
+	}
+	for(int clientId: connectedClients)
+	{
+		PushState& push = laneFor(clientId, formatOf(clientId));
+		if(&push == &_deltaPush && deltaOwed)
+			continue;
+		deltaOwed = deltaOwed || &push == &_deltaPush;
+
+		uint32_t elapsed = now - push.sent_ms;
+		uint32_t limit = push.pending ? laneInterval(push) : TELEMETRY_HEARTBEAT_MS;
+		wait = std::min(wait, elapsed >= limit ? 0 : limit - elapsed);
+	}
+	xSemaphoreGive(clientListMutex);
+
+	TickType_t ticks = pdMS_TO_TICKS(wait);
+	return ticks > 0 ? ticks : 1;
+}
+
+std::vector<ClientQueueStats> DataHandler::clientStats()
+{
+	std::vector<ClientQueueStats> result;
+	xSemaphoreTake(clientListMutex, portMAX_DELAY);
+	result.reserve(connectedClients.size());
+	for(int clientId: connectedClients)
+	{
+		ClientQueueStats stats = _push[clientId].stats;
+		stats.clientId = clientId;
+		stats.format = formatOf(clientId);
+		result.push_back(stats);
+	}
+	xSemaphoreGive(clientListMutex);
+	return result;
+}
+
+void DataHandler::recordHistory()
+{
+	const OutBox input = MBManager.getInputPower();
+	const OutBox output = MBManager.getoutputPower();
+	HistorySample sample;
+	sample.t_ms = millis();
+	sample.state = static_cast<uint8_t>(_currentState.load());
+	sample.values = {input.voltage,  input.current,  input.power,  input.powerfactor,
+					 output.voltage, output.current, output.power, output.powerfactor};
+	_history.record(sample);
+}
+
+// True when appending digit to value would not fit in a uint32_t
+static bool overflows(uint32_t value, char digit)
+{
+	return value > (UINT32_MAX - static_cast<uint32_t>(digit - '0')) / 10;
+}
+
+bool DataHandler::requestHistory(AsyncWebSocketClient* client, const char* data, size_t len)
+{
+	static const char PREFIX[] = "history";
+	const size_t prefixLen = sizeof(PREFIX) - 1;
+	if(len < prefixLen || memcmp(data, PREFIX, prefixLen) != 0 ||
+	   (len > prefixLen && data[prefixLen] != ':' && data[prefixLen] != '#'))
+	{
+		return false;
+	}
+
+	// Up to three comma-separated numbers, then the optional request id
+	uint32_t fields[3] = {0, 0, 0};
+	size_t field = 0;
+	uint32_t requestId = 0;
+	bool tagged = false;
+	size_t i = prefixLen;
+	if(i < len && data[i] == ':')
+	{
+		++i;
+	}
+	for(; i < len; ++i)
+	{
+		char c = data[i];
+		if(c == '#' && !tagged)
+		{
+			tagged = true;
+		}
+		else if(c == ',' && !tagged && field < 2)
+		{
+			++field;
+		}
+		else if(c >= '0' && c <= '9' && !overflows(tagged ? requestId : fields[field], c))
+		{
+			uint32_t& value = tagged ? requestId : fields[field];
+			value = value * 10 + static_cast<uint32_t>(c - '0');
+		}
+		else
+		{
+			// A time past the uint32_t clock would wrap into some other part of the history
+			replyCommand(client, "nack", "history", requestId);
+			return true;
+		}
+	}
+
+	HistoryCursor cursor;
+	cursor.from_ms = fields[0] != 0 ? fields[0] : _history.oldest();
+	cursor.to_ms = fields[1] != 0 ? fields[1] : millis();
+	cursor.step_ms = std::max(fields[2], HISTORY_SAMPLE_MS);
+	cursor.requestId = requestId;
+
+	char reply[WS_BUFFER_SIZE];
+	snprintf(reply, sizeof(reply),
+			 R"({"type":"history","id":%u,"from":%u,"to":%u,"step":%u,"samples":%u})",
+			 requestId, cursor.from_ms, cursor.to_ms, cursor.step_ms,
+			 static_cast<unsigned>(_history.sampleCount()));
+	if(xSemaphoreTake(websocketMutex, portMAX_DELAY) == pdTRUE)
+	{
+		client->text(reply);
+		xSemaphoreGive(websocketMutex);
+	}
+
+	// A new request from the same client replaces the one in progress
+	xSemaphoreTake(clientListMutex, portMAX_DELAY);
+	_historyCursors[client->id()] = cursor;
+	xSemaphoreGive(clientListMutex);
+	if(dataTaskHandler != NULL)
+	{
+		xTaskNotify(dataTaskHandler, WS_MESSAGE_NOTIFY, eSetBits);
+	}
+	return true;
+}
+
+bool DataHandler::serveHistory(AsyncWebSocket* websocket)
+{
+	xSemaphoreTake(websocketMutex, portMAX_DELAY);
+	xSemaphoreTake(clientListMutex, portMAX_DELAY);
+	for(auto it = _historyCursors.begin(); it != _historyCursors.end();)
+	{
+		AsyncWebSocketClient* client = websocket->client(it->first);
+		if(client == nullptr || client->status() != WS_CONNECTED)
+		{
+			it = _historyCursors.erase(it);
+			continue;
+		}
+		// Leave the rest of the queue to readings; the cursor stays until its last chunk is out
+		if(client->queueLen() >= HISTORY_QUEUE_LIMIT || !client->canSend() ||
+		   !sendHistoryChunk(client, it->second))
+		{
+			++it;
+			continue;
+		}
+		it = _historyCursors.erase(it);
+	}
+	bool running = !_historyCursors.empty();
+	xSemaphoreGive(clientListMutex);
+	xSemaphoreGive(websocketMutex);
+	return running;
+}
+
+// Chunk n carries the buckets it covers and the events up to where it stops, so a client can
+// merge chunks as they come; true once the last one is sent. Callers hold websocketMutex.
+bool DataHandler::sendHistoryChunk(AsyncWebSocketClient* client, HistoryCursor& cursor)
+{
+	JsonDocument doc;
+	doc["type"] = "historyChunk";
+	doc["id"] = cursor.requestId;
+	doc["chunk"] = cursor.chunk++;
+	doc["step"] = cursor.step_ms;
+
+	// Rows are [t, state, in V, A, W, pf, out V, A, W, pf]
+	JsonArray samples = doc["samples"].to<JsonArray>();
+	auto addSample = [&samples](const HistorySample& sample) {
+		JsonArray row = samples.add<JsonArray>();
+		row.add(sample.t_ms);
+		row.add(sample.state);
+		for(float value: sample.values)
+		{
+			row.add(value);
+		}
+	};
+	JsonArray events = doc["events"].to<JsonArray>();
+	auto addEvent = [&events](const HistoryEvent& event) {
+		JsonObject entry = events.add<JsonObject>();
+		entry["t"] = event.t_ms;
+		if(event.mode)
+		{
+			bool autoMode = static_cast<TestMode>(event.value) == TestMode::AUTO;
+			entry["mode"] = autoMode ? "AUTO" : "MANUAL";
+		}
+		else
+		{
+			entry["state"] = Node_Utility::ToString::state(static_cast<State>(event.value));
+		}
+	};
+
+	uint32_t chunkFrom = cursor.from_ms;
+	size_t buckets = _history.read(cursor.from_ms, cursor.to_ms, cursor.step_ms,
+								   HISTORY_CHUNK_SAMPLES, addSample);
+	bool last = buckets < HISTORY_CHUNK_SAMPLES;
+	_history.readEvents(chunkFrom, last ? cursor.to_ms + 1 : cursor.from_ms, addEvent);
+	doc["last"] = last;
+
+	AsyncWebSocketSharedBuffer frame = serializeFrame(doc, HISTORY_CHUNK_BYTES);
+	if(frame)
+	{
+		client->text(frame);
+	}
+	return last;
+}
+
+size_t DataHandler::sseClients() const
+{
+	AsyncEventSource* events = _events.load();
+	return events != nullptr ? events->count() : 0;
+}
+
+// The frame is the JSON the WebSocket clients got. It is not NUL-terminated, and the library wants
+// a C string, so it is copied into _sseText, which only the data task touches.
+void DataHandler::publishSse(const AsyncWebSocketSharedBuffer& frame)
+{
+	AsyncEventSource* events = _events.load();
+	if(events == nullptr)
+	{
+		return;
+	}
+
+	uint32_t started = micros();
+	xSemaphoreTake(sseMutex, portMAX_DELAY);
+	uint32_t id = ++_sseSequence;
+	SseReplay& replay = _sseReplay[id % SSE_REPLAY_EVENTS];
+	replay.id = id;
+	replay.frame = frame;
+	xSemaphoreGive(sseMutex);
+
+	size_t viewers = events->count();
+	_sseText.assign(reinterpret_cast<const char*>(frame->data()), frame->size());
+	events->send(_sseText.c_str(), "readings", id);
+	recordFrame(_sseFanoutStats, frame->size() * viewers, micros() - started);
+}
+
+// A browser resuming with Last-Event-ID gets the frames after it that are still held; a new one,
+// or one too far behind, gets the latest so it has values at once
+void DataHandler::replaySse(AsyncEventSourceClient* client)
+{
+	uint32_t lastId = client->lastId();
+	std::array<SseReplay, SSE_REPLAY_EVENTS> pending;
+	size_t count = 0;
+
+	xSemaphoreTake(sseMutex, portMAX_DELAY);
+	uint32_t newest = _sseSequence;
+	uint32_t oldest = newest > SSE_REPLAY_EVENTS ? newest - SSE_REPLAY_EVENTS + 1 : 1;
+	if(lastId == 0 || lastId < oldest - 1 || lastId > newest)
+	{
+		lastId = newest > 0 ? newest - 1 : 0;
+	}
+	for(uint32_t id = lastId + 1; id <= newest; ++id)
+	{
+		const SseReplay& replay = _sseReplay[id % SSE_REPLAY_EVENTS];
+		if(replay.id == id && replay.frame)
+			pending[count++] = replay;
+	}
+	xSemaphoreGive(sseMutex);
+
+	std::string text;
+	for(size_t i = 0; i < count; ++i)
+	{
+		const AsyncWebSocketSharedBuffer& frame = pending[i].frame;
+		text.assign(reinterpret_cast<const char*>(frame->data()), frame->size());
+		client->send(text.c_str(), "readings", pending[i].id, i == 0 ? SSE_RETRY_MS : 0);
+	}
+}
+
+AsyncWebSocketSharedBuffer DataHandler::serializeFrame(const JsonDocument& doc, size_t limit)
+{
+	AsyncWebSocketSharedBuffer frame;
+	switch(encodeJsonFrame(doc, limit, frame))
+	{
+		case FrameError::EMPTY_JSON:
+			logger.log(LogLevel::ERROR, "Serialization failed: Empty JSON.");
+			break;
+		case FrameError::TOO_LONG:
+			logger.log(LogLevel::ERROR, "Serialization failed: Buffer overflow.");
+			break;
+		case FrameError::INVALID_UTF8:
+			logger.log(LogLevel::ERROR, "Invalid UTF-8 data detected.");
+			break;
+		default:
+			break;
+	}
+	return frame;
 }
 
 void DataHandler::sendData(AsyncWebSocketClient* client, wsOutGoingDataType type)
@@ -323,73 +891,271 @@ void DataHandler::sendData(AsyncWebSocketClient* client, wsOutGoingDataType type
 	}
 }
 
-void DataHandler::handleWsIncomingCommands(wsIncomingCommands cmd)
+static const char* commandName(UserCommandEvent command)
+{
+	switch(command)
+	{
+		case UserCommandEvent::START:
+			return "start";
+		case UserCommandEvent::STOP:
+			return "stop";
+		case UserCommandEvent::AUTO:
+			return "AUTO";
+		case UserCommandEvent::MANUAL:
+			return "MANUAL";
+		case UserCommandEvent::PAUSE:
+			return "pause";
+		case UserCommandEvent::RESUME:
+			return "resume";
+	}
+	return "unknown";
+}
+
+bool DataHandler::dispatchCommand(AsyncWebSocketClient* client, const char* data, size_t len)
+{
+	uint32_t received_us = micros();
+
+	// "<command>#<request id>"; a bare command gets id 0, a '#' needs a uint32_t behind it.
+	// Parsed in place, data is the frame.
+	const char* tag = static_cast<const char*>(memchr(data, '#', len));
+	size_t nameLen = tag != nullptr ? static_cast<size_t>(tag - data) : len;
+	if(tag != nullptr && tag + 1 == data + len)
+	{
+		return false;
+	}
+	uint32_t requestId = 0;
+	for(const char* digit = tag != nullptr ? tag + 1 : data + len; digit < data + len; ++digit)
+	{
+		if(*digit < '0' || *digit > '9' || overflows(requestId, *digit))
+			return false;
+		requestId = requestId * 10 + static_cast<uint32_t>(*digit - '0');
+	}
+
+	const WsCommandName* command = findWsCommand(data, nameLen);
+	if(command == nullptr)
+	{
+		return false;
+	}
+	wsIncomingCommands cmd = command->cmd;
+	switch(cmd)
+	{
+		case wsIncomingCommands::TEST_START:
+		case wsIncomingCommands::TEST_STOP:
+		case wsIncomingCommands::TEST_PAUSE:
+		case wsIncomingCommands::AUTO_MODE:
+		case wsIncomingCommands::MANUAL_MODE:
+			break;
+		case wsIncomingCommands::LOAD_ON:
+		case wsIncomingCommands::LOAD_OFF:
+		case wsIncomingCommands::MAINS_ON:
+		case wsIncomingCommands::MAINS_OFF:
+			// Known names with nothing behind them yet
+			_commandsRejected++;
+			replyCommand(client, "nack", command->text, requestId, "unsupported");
+			return true;
+		default:
+			return false;
+	}
+
+	CommandRequest request;
+	request.requestId = requestId;
+	request.clientId = client->id();
+	request.received_us = received_us;
+	if(handleWsIncomingCommands(cmd, request))
+	{
+		_commandsAccepted++;
+		replyCommand(client, "ack", command->text, requestId);
+	}
+	else
+	{
+		_commandsRejected++;
+		replyCommand(client, "nack", command->text, requestId, "queue full");
+	}
+	return true;
+}
+
+void DataHandler::replyCommand(AsyncWebSocketClient* client, const char* type, const char* name,
+							   uint32_t requestId, const char* reason)
+{
+	char reply[WS_BUFFER_SIZE];
+	if(reason != nullptr)
+	{
+		snprintf(reply, sizeof(reply), R"({"type":"%s","cmd":"%s","id":%u,"reason":"%s"})",
+				 type, name, static_cast<unsigned>(requestId), reason);
+	}
+	else
+	{
+		snprintf(reply, sizeof(reply), R"({"type":"%s","cmd":"%s","id":%u})", type, name,
+				 static_cast<unsigned>(requestId));
+	}
+
+	if(xSemaphoreTake(websocketMutex, portMAX_DELAY) == pdTRUE)
+	{
+		client->text(reply);
+		xSemaphoreGive(websocketMutex);
+	}
+}
+
+CommandStats DataHandler::commandStats() const
+{
+	CommandStats stats;
+	stats.accepted = _commandsAccepted.load();
+	stats.rejected = _commandsRejected.load();
+	stats.completed = _commandsCompleted.load();
+	stats.overBudget = _commandsOverBudget.load();
+	stats.lastDispatch_us = _lastDispatch_us.load();
+	stats.lastTotal_us = _lastTotal_us.load();
+	xSemaphoreTake(commandStatsMutex, portMAX_DELAY);
+	stats.dispatch = _dispatchLatency;
+	stats.total = _totalLatency;
+	xSemaphoreGive(commandStatsMutex);
+	return stats;
+}
+
+void DataHandler::completeCommand(const CommandRequest& request, uint32_t dispatched_us)
+{
+	uint32_t done_us = micros();
+	uint32_t dispatch_us = dispatched_us - request.received_us;
+	uint32_t total_us = done_us - request.received_us;
+	_commandsCompleted++;
+	_lastDispatch_us = dispatch_us;
+	_lastTotal_us = total_us;
+	xSemaphoreTake(commandStatsMutex, portMAX_DELAY);
+	_dispatchLatency.record(dispatch_us);
+	_totalLatency.record(total_us);
+	xSemaphoreGive(commandStatsMutex);
+	if(dispatch_us > COMMAND_LATENCY_BUDGET_MS * 1000)
+	{
+		_commandsOverBudget++;
+		logger.log(LogLevel::WARNING, "Command %s waited %u us for dispatch",
+				   commandName(request.command), static_cast<unsigned>(dispatch_us));
+	}
+
+	AsyncWebSocket* websocket = _websocket.load();
+	if(websocket == nullptr || request.clientId < 0)
+	{
+		return;
+	}
+
+	JsonDocument doc;
+	doc["type"] = "done";
+	doc["cmd"] = commandName(request.command);
+	doc["id"] = request.requestId;
+	doc["state"] = Node_Utility::ToString::state(_currentState);
+	doc["dispatchUs"] = dispatch_us;
+	doc["totalUs"] = total_us;
+	sendFrame(websocket, request.clientId, serializeFrame(doc));
+	// The command may have changed what the LEDs show
+	sendData(websocket, request.clientId, wsOutGoingDataType::LED_STATUS);
+}
+
+bool DataHandler::handleWsIncomingCommands(wsIncomingCommands cmd, CommandRequest& request)
 {
 	if(cmd == wsIncomingCommands::TEST_START)
 	{
 		_blinkRed = true;
 		logger.log(LogLevel::SUCCESS, "handling TEST START EVENT");
-		handleUserCommand(UserCommandEvent::START);
+		request.command = UserCommandEvent::START;
 	}
 	else if(cmd == wsIncomingCommands::TEST_STOP)
 	{
 		_blinkRed = false;
 		logger.log(LogLevel::SUCCESS, "handling TEST STOP EVENT");
-		handleUserCommand(UserCommandEvent::STOP);
+		request.command = UserCommandEvent::STOP;
 	}
 	else if(cmd == wsIncomingCommands::TEST_PAUSE)
 	{
 		_blinkRed = false;
 		logger.log(LogLevel::SUCCESS, "handling TEST PAUSE EVENT");
-		handleUserCommand(UserCommandEvent::PAUSE);
+		request.command = UserCommandEvent::PAUSE;
 	}
 	else if(cmd == wsIncomingCommands::AUTO_MODE)
 	{
 		_blinkBlue = true;
-		handleUserCommand(UserCommandEvent::AUTO);
+		request.command = UserCommandEvent::AUTO;
 		logger.log(LogLevel::SUCCESS, "handling command set to AUTO ");
 	}
 	else if(cmd == wsIncomingCommands::MANUAL_MODE)
 	{
 		_blinkBlue = false;
-		handleUserCommand(UserCommandEvent::MANUAL);
+		request.command = UserCommandEvent::MANUAL;
 		logger.log(LogLevel::SUCCESS, "handling command set to MANUAL ");
 	}
 	else
 	{
 		logger.log(LogLevel::ERROR, "invalid command ");
+		return false;
 	}
+	return handleUserCommand(request);
 }
 
-void DataHandler::handleUserCommand(UserCommandEvent command)
+bool DataHandler::handleUserCommand(const CommandRequest& request)
 {
-	EventBits_t commandBits = static_cast<EventBits_t>(command);
-	switch(command)
+	if(!TestSync::getInstance().submitCommand(request))
 	{
-		case UserCommandEvent ::PAUSE:
-			EventHelper::clearBits(UserCommandEvent::RESUME);
-			break;
-		case UserCommandEvent ::RESUME:
-			EventHelper::clearBits(UserCommandEvent::PAUSE);
-			break;
-		case UserCommandEvent ::AUTO:
-			EventHelper::clearBits(UserCommandEvent::MANUAL);
+		logger.log(LogLevel::ERROR, "Command queue full, dropping %s",
+				   commandName(request.command));
+		return false;
+	}
+	return true;
+}
 
-			break;
-		case UserCommandEvent ::MANUAL:
-			EventHelper::clearBits(UserCommandEvent::AUTO);
+void DataHandler::fillTelemetry(pg_TelemetryFrame& frame)
+{
+	frame = pg_TelemetryFrame();
+	frame.timestamp_ms = millis();
+	frame.state = static_cast<uint32_t>(_currentState.load());
 
-			break;
-		case UserCommandEvent ::START:
-			EventHelper::clearBits(UserCommandEvent::STOP);
-			break;
-		case UserCommandEvent ::STOP:
-			EventHelper::clearBits(UserCommandEvent::START);
-			break;
-		default:
-			break;
+	MBManager.forEachMeter([&frame](const MeterRegistry::MeterInfo& info, const OutBox& measure) {
+		pg_PowerMeasureType type = info.role == MeterRole::INPUT	? pg_PowerMeasureType_UPS_INPUT
+								   : info.role == MeterRole::OUTPUT ? pg_PowerMeasureType_UPS_OUTPUT
+																	: pg_PowerMeasureType_MAINS;
+		addTelemetryChannel(frame, type, info.plate.id, measure);
+	});
+}
+
+AsyncWebSocketSharedBuffer DataHandler::encodeTelemetry()
+{
+	fillTelemetry(_telemetryFrame);
+	_telemetryFrame.sequence = ++_telemetrySequence;
+	// Self-contained, so a delta client moved off the shared stream can apply it as a key frame
+	_telemetryFrame.key_frame = true;
+	return encodeFrame(_telemetryFrame);
+}
+
+AsyncWebSocketSharedBuffer DataHandler::encodeDeltaTelemetry()
+{
+	fillTelemetry(_telemetryFrame);
+	_delta.next(_telemetryFrame);
+	return encodeFrame(_telemetryFrame);
+}
+
+// For a delta client that lost track; called right after encodeDeltaTelemetry(), whose header
+// is still in _telemetryFrame
+AsyncWebSocketSharedBuffer DataHandler::encodeDeltaKeyFrame()
+{
+	_delta.keyFrame(_telemetryFrame);
+	return encodeFrame(_telemetryFrame);
+}
+
+AsyncWebSocketSharedBuffer DataHandler::encodeFrame(const pg_TelemetryFrame& frame)
+{
+	const char* error = nullptr;
+	AsyncWebSocketSharedBuffer buffer = encodeTelemetryFrame(frame, error);
+	if(!buffer)
+	{
+		logger.log(LogLevel::ERROR, "Telemetry encode failed: %s", error);
 	}
-	xEventGroupSetBits(EventHelper::userCommandEventGroup, commandBits);
+	return buffer;
+}
+
+void DataHandler::recordFrame(FrameStats& stats, size_t bytes, uint32_t encode_us)
+{
+	stats.frames++;
+	stats.lastBytes = bytes;
+	stats.lastEncode_us = encode_us;
+	stats.totalBytes += bytes;
+	stats.totalEncode_us += encode_us;
 }
 
 JsonDocument DataHandler::prepData(wsOutGoingDataType type)
@@ -397,16 +1163,23 @@ JsonDocument DataHandler::prepData(wsOutGoingDataType type)
 	JsonDocument doc;
 	if(type == wsOutGoingDataType::POWER_READINGS)
 	{
-		// Populate the JSON document with these random values
-		doc["inputCurrent"] = MBManager.getInputPower().current;
-		doc["outputCurrent"] = MBManager.getoutputPower().current;
-		doc["inputVoltage"] = MBManager.getInputPower().voltage;
-		doc["outputVoltage"] = MBManager.getoutputPower().voltage;
-		;
-		doc["inputPowerFactor"] = MBManager.getInputPower().powerfactor;
-		doc["outputPowerFactor"] = MBManager.getoutputPower().powerfactor;
-		doc["inputWattage"] = MBManager.getInputPower().power;
-		doc["outputWattage"] = MBManager.getoutputPower().power;
+		// Populate the JSON document with the latest meter readings, one copy per side
+		fillReadingsJson(doc, MBManager.getInputPower(), MBManager.getoutputPower());
+	}
+	else if(type == wsOutGoingDataType::LED_STATUS)
+	{
+		logger.log(LogLevel::INTR, "CURRENT  STATE FOR LED %s ",
+				   Node_Utility::ToString::state(_currentState));
+
+		if(_currentState == State::READY_TO_PROCEED)
+		{
+			_blinkGreen = true;
+		}
+
+		doc["type"] = "LED_STATUS";
+		doc["blinkBlue"] = _blinkBlue;
+		doc["blinkGreen"] = _blinkGreen;
+		doc["blinkRed"] = _blinkRed;
 	}
 	else
 	{
@@ -416,50 +1189,6 @@ JsonDocument DataHandler::prepData(wsOutGoingDataType type)
 	return doc;
 }
 
-wsIncomingCommands DataHandler::getWebSocketCommand(const char* incomingCommand)
-{
-	if(strcmp(incomingCommand, "start") == 0)
-
-		return wsIncomingCommands::TEST_START;
-	if(strcmp(incomingCommand, "stop") == 0)
-		return wsIncomingCommands::TEST_STOP;
-	if(strcmp(incomingCommand, "pause") == 0)
-		return wsIncomingCommands::TEST_PAUSE;
-	if(strcmp(incomingCommand, "AUTO") == 0)
-		return wsIncomingCommands::AUTO_MODE;
-	if(strcmp(incomingCommand, "MANUAL") == 0)
-		return wsIncomingCommands::MANUAL_MODE;
-	if(strcmp(incomingCommand, "Load On") == 0)
-		return wsIncomingCommands::LOAD_ON;
-	if(strcmp(incomingCommand, "Load Off") == 0)
-		return wsIncomingCommands::LOAD_OFF;
-	if(strcmp(incomingCommand, "Mains On") == 0)
-		return wsIncomingCommands::MAINS_ON;
-	if(strcmp(incomingCommand, "Mains Off") == 0)
-		return wsIncomingCommands::MAINS_OFF;
-	if(strcmp(incomingCommand, "getReadings") == 0)
-		return wsIncomingCommands::GET_READINGS;
-	return wsIncomingCommands::INVALID_COMMAND;
-}
-bool DataHandler::isValidUTF8(const char* data, size_t len)
-{
-	for(size_t i = 0; i < len; i++)
-	{
-		unsigned char c = static_cast<unsigned char>(data[i]);
-		if(c <= 0x7F)
-			continue; // ASCII
-		if((c >> 5) == 0x6)
-			i++; // 2-byte sequence
-		else if((c >> 4) == 0xE)
-			i += 2; // 3-byte sequence
-		else if((c >> 3) == 0x1E)
-			i += 3; // 4-byte sequence
-		else
-			return false; // Invalid UTF-8
-	}
-	return true;
-}
-
 // void DataHandler::fillPeriodicDeque()
 // {
 // 	StaticJsonDocument<WS_BUFFER_SIZE> wsData = prepData(wsOutGoingDataType::POWER_READINGS);
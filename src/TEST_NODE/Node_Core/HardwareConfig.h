@@ -4,6 +4,7 @@
 
 #define RX_RS485_PIN 16
 #define TX_RS485_PIN 17
+#define RS485_RTS_PIN -1 // DE/RE driver enable, -1 for auto-direction transceivers
 
 #define thermoSO_PIN 19 // VSPI MISO PIN
 #define thermoSCK_PIN 18 // VSPI_CLK
@@ -98,9 +98,10 @@ struct OutBox
 	float frequency;
 	float powerfactor;
 	bool isValid;
+	uint16_t calibrationVersion; // SetupCalibration::version applied, 0 = uncorrected
 	OutBox() :
 		device_id(0), type(MeasureType::ANY), voltage(0), current(0), power(0), energy(0),
-		frequency(0), powerfactor(-1), isValid(false)
+		frequency(0), powerfactor(-1), isValid(false), calibrationVersion(0)
 	{
 	}
 };
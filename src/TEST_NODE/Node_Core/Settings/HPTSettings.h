@@ -22,6 +22,7 @@ static const uint32_t backupTest_Stack = 4096;
 
 static const uint32_t monitor_Stack = 2048;
 static const uint32_t modbus_Stack = 4096;
+static const uint32_t modbusDispatch_Stack = 4096;
 static const uint32_t timer_Stack = 4096;
 // ALL task Priority
 static const UBaseType_t AsyncTCP_Priority = 10;
@@ -42,6 +43,7 @@ static const UBaseType_t BackUpTest_Priority = 2;
 
 static const UBaseType_t monitor_Priority = 1;
 static const UBaseType_t modbus_Priority = 1;
+static const UBaseType_t modbusDispatch_Priority = 2;
 static const UBaseType_t timer_Priority = 1;
 // ALL task Core
 static const BaseType_t AsyncTCP_CORE = 1;
@@ -62,5 +64,7 @@ static const BaseType_t BackUpTest_CORE = 1;
 
 static const BaseType_t monitor_CORE = 1;
 static const BaseType_t modbus_CORE = tskNO_AFFINITY;
+static const BaseType_t modbusDispatch_CORE = tskNO_AFFINITY;
+static const BaseType_t modbusServer_CORE = tskNO_AFFINITY;
 static const BaseType_t timer_CORE = 0;
 #endif
\ No newline at end of file
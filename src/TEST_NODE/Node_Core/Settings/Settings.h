@@ -491,7 +491,7 @@ struct SetupModbus
 	uint8_t slaveID = 1;
 	uint8_t databits = 8;
 	uint8_t stopbits = 1;
-	uint8_t parity = 0;
+	uint8_t parity = 0; // 0 = none, 1 = odd, 2 = even
 	unsigned long baudrate = 9600;
 	unsigned long lastsetting_updated = 0UL;
 	enum class Field
@@ -505,6 +505,48 @@ struct SetupModbus
 	};
 };
 
+// Per-meter correction applied to every reading as value * gain + offset. ctRatio multiplies
+// current, power and energy on top of gain for meters that read through a current transformer.
+struct MeterCalibration
+{
+	enum class Quantity
+	{
+		Voltage,
+		Current,
+		Power,
+		Energy,
+		Frequency,
+		PowerFactor
+	};
+	static constexpr size_t QUANTITIES = 6;
+
+	uint8_t meterId = 0xFF; // Unused channel
+	float ctRatio = 1.0f;
+	float gain[QUANTITIES] = {1.0f, 1.0f, 1.0f, 1.0f, 1.0f, 1.0f};
+	float offset[QUANTITIES] = {0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f};
+};
+
+struct SetupCalibration
+{
+	static constexpr size_t MAX_CHANNELS = 8;
+
+	MeterCalibration channels[MAX_CHANNELS];
+	uint8_t channelCount = 0;
+	uint16_t version = 0; // Bump on every change; results record the version they used
+	unsigned long lastsetting_updated = 0UL;
+
+	// nullptr when the meter has no channel and reads uncorrected
+	const MeterCalibration* channel(uint8_t meterId) const
+	{
+		for(uint8_t i = 0; i < channelCount && i < MAX_CHANNELS; ++i)
+		{
+			if(channels[i].meterId == meterId)
+				return &channels[i];
+		}
+		return nullptr;
+	}
+};
+
 struct SetupReport
 {
 	bool enableReport = true;
@@ -588,6 +630,7 @@ struct SetupUPSTest
 	SetupNetwork commSetting;
 	SetupModbus modbusSetting;
 	SetupReport reportSetting;
+	SetupCalibration calibrationSetting;
 	unsigned long lastsetting_updated;
 
 	SetupUPSTest(SetupSpec sp = SetupSpec(), SetupTest ts = SetupTest(),
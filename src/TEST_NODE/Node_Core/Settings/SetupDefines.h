@@ -17,7 +17,8 @@ enum class SettingType
 	HARDWARE,
 	NETWORK,
 	MODBUS,
-	REPORT
+	REPORT,
+	CALIBRATION
 };
 
 
@@ -8,6 +8,7 @@
 #include "DataHandler.h"
 #include "TestManager.h"
 #include "NodeUtility.hpp"
+#include "PZEM_Modbus.hpp"
 
 using namespace Node_Core;
 extern Logger& logger;
@@ -78,6 +79,8 @@ void StateMachine::NotifyStateChanged(State state)
 	DataHandler::getInstance().updateState(state);
 	TestSync::getInstance().updateState(state);
 	TestManager::getInstance().updateState(state);
+	Node_Utility::ModbusManager::getInstance().updateState(state);
+	Node_Utility::ModbusStatusServer::getInstance().publishState(state);
 
 	if(isAutoMode())
 	{
@@ -109,11 +109,12 @@ struct TestData
 	unsigned long endtime;
 	LoadPercentage load_percentage : 7;
 	bool valid_data : 1;
+	uint16_t calibration_version; // Meter calibration in effect when the result was taken
 
 	// Default constructor for TestData
 	TestData() :
 		testNo(0), testTimestamp(0), starttime(0), endtime(0),
-		load_percentage(LoadPercentage::LOAD_0P), valid_data(false)
+		load_percentage(LoadPercentage::LOAD_0P), valid_data(false), calibration_version(0)
 	{
 	}
 };
@@ -3,6 +3,9 @@
 #include "DataHandler.h"
 #include "HPTSettings.h"
 #include "NodeUtility.hpp"
+#include "PZEM_Modbus.hpp"
+
+extern Node_Utility::ModbusManager& MBManager;
 
 TestSync& TestSync::getInstance()
 {
@@ -23,6 +26,8 @@ TestSync::TestSync() :
 		_testList[i].isActive = false;
 		_testID[i] = i * 2 + 31;
 	}
+	commandQueue = xQueueCreate(USER_COMMAND_QUEUE_SIZE, sizeof(CommandRequest));
+	configASSERT(commandQueue);
 }
 
 void TestSync::init()
@@ -70,6 +75,11 @@ State getState()
 	return StateMachine::getInstance().getCurrentState();
 }
 
+bool TestSync::submitCommand(const CommandRequest& request)
+{
+	return xQueueSend(commandQueue, &request, 0) == pdTRUE;
+}
+
 bool TestSync::iscmdAcknowledged()
 {
 	return _cmdAcknowledged;
@@ -100,6 +110,8 @@ void TestSync::startTest(TestType test)
 	if(isTestEnabled())
 	{
 		EventHelper::setBits(test);
+		MBManager.updateTest(test, true);
+		Node_Utility::ModbusStatusServer::getInstance().publishTest(test, true);
 		logger.log(LogLevel::WARNING, "test %s will be started", testTypeToString(test));
 		disableCurrentTest();
 		vTaskDelay(pdMS_TO_TICKS(50));
@@ -109,6 +121,8 @@ void TestSync::startTest(TestType test)
 void TestSync::stopTest(TestType test)
 {
 	EventHelper::clearBits(test);
+	MBManager.updateTest(test, false);
+	Node_Utility::ModbusStatusServer::getInstance().publishTest(test, false);
 	logger.log(LogLevel::WARNING, "test %s will be stopped", testTypeToString(test));
 	vTaskDelay(pdMS_TO_TICKS(50));
 }
@@ -116,6 +130,8 @@ void TestSync::stopTest(TestType test)
 void TestSync::stopAllTest()
 {
 	EventHelper::resetAllTestBits();
+	MBManager.updateTest(TestType::SwitchTest, false);
+	Node_Utility::ModbusStatusServer::getInstance().publishTest(TestType::SwitchTest, false);
 	logger.log(LogLevel::WARNING, "All test stopped");
 	vTaskDelay(pdMS_TO_TICKS(50));
 }
@@ -488,94 +504,80 @@ void TestSync::handleSyncCommand(SyncCommand command)
 void TestSync::userCommandTask(void* pvParameters)
 {
 	TestSync& instance = TestSync::getInstance();
-
-	const EventBits_t CMD_BITS_MASK = static_cast<EventBits_t>(UserCommandEvent::START) |
-									  static_cast<EventBits_t>(UserCommandEvent::STOP) |
-									  static_cast<EventBits_t>(UserCommandEvent::AUTO) |
-									  static_cast<EventBits_t>(UserCommandEvent::MANUAL) |
-									  static_cast<EventBits_t>(UserCommandEvent::PAUSE) |
-									  static_cast<EventBits_t>(UserCommandEvent::RESUME);
+	CommandRequest request;
 
 	State syncState = StateMachine::getInstance().getCurrentState();
 	logger.log(LogLevel::INFO, "Sync Class state is:%s", Node_Utility::ToString::state(syncState));
 
-	while(xEventGroupWaitBits(EventHelper::userCommandEventGroup, CMD_BITS_MASK, pdFALSE, pdFALSE,
-							  portMAX_DELAY))
+	// Commands are consumed in arrival order, each exactly once, with no polling delay
+	while(xQueueReceive(instance.commandQueue, &request, portMAX_DELAY) == pdTRUE)
 	{
-		int cmdResult = xEventGroupGetBits(EventHelper::userCommandEventGroup);
+		uint32_t dispatched_us = micros();
 		logger.log(LogLevel::SUCCESS, "New User Command Received");
+		instance.runCommand(request.command);
+		DataHandler::getInstance().completeCommand(request, dispatched_us);
+	}
+	vTaskDelete(NULL);
+}
 
-		if((cmdResult & static_cast<EventBits_t>(UserCommandEvent::AUTO)) != 0)
-		{
+void TestSync::runCommand(UserCommandEvent command)
+{
+	switch(command)
+	{
+		case UserCommandEvent::AUTO:
 			StateMachine::getInstance().handleMode(TestMode::AUTO);
-			instance.handleSyncCommand(SyncCommand::START_OBSERVER);
-			instance.acknowledgeCMD();
-			logger.log(LogLevel::WARNING, "clearing AUTO command bits");
-			EventHelper::clearBits(UserCommandEvent::AUTO);
-		}
-		else if((cmdResult & static_cast<EventBits_t>(UserCommandEvent::MANUAL)) != 0)
-		{
+			handleSyncCommand(SyncCommand::START_OBSERVER);
+			acknowledgeCMD();
+			break;
+		case UserCommandEvent::MANUAL:
 			StateMachine::getInstance().handleMode(TestMode::MANUAL);
-			instance.handleSyncCommand(SyncCommand::STOP_OBSERVER);
-			instance.acknowledgeCMD();
-			logger.log(LogLevel::WARNING, "clearing MANUAL command bits");
-			EventHelper::clearBits(UserCommandEvent::MANUAL);
-		}
-		else if((cmdResult & static_cast<EventBits_t>(UserCommandEvent::START)) != 0)
-
-		{
+			handleSyncCommand(SyncCommand::STOP_OBSERVER);
+			acknowledgeCMD();
+			break;
+		case UserCommandEvent::START:
 			logger.log(LogLevel::INFO, "Reporting START Event--->");
-			instance.reportEvent(Event::START);
+			reportEvent(Event::START);
 			logger.log(LogLevel::INFO, "Activating Manager--->");
-			instance.handleSyncCommand(SyncCommand::MANAGER_ACTIVE);
+			handleSyncCommand(SyncCommand::MANAGER_ACTIVE);
 			if(StateMachine::getInstance().isManualMode())
 			{
 				logger.log(LogLevel::INFO, "Starting first manual test--->");
-				instance.startTest(instance._testList[0].testType);
+				startTest(_testList[0].testType);
 			}
-			instance.acknowledgeCMD();
-			logger.log(LogLevel::INFO, "Clearing Start bit after acknowledgement--->");
-			EventHelper::clearBits(UserCommandEvent::START);
-		}
-		else if((cmdResult & static_cast<EventBits_t>(UserCommandEvent::STOP)) != 0)
-		{
+			acknowledgeCMD();
+			break;
+		case UserCommandEvent::STOP:
 			logger.log(LogLevel::INFO, "Stopping current test in AUTO Mode--->");
-			instance.UserStopTest();
+			UserStopTest();
 			logger.log(LogLevel::INFO, "Stopping Observer--->");
-			instance.handleSyncCommand(SyncCommand::STOP_OBSERVER);
+			handleSyncCommand(SyncCommand::STOP_OBSERVER);
 			logger.log(LogLevel::INFO, "Reporting STOP Event--->");
-			instance.reportEvent(Event::STOP);
+			reportEvent(Event::STOP);
 
 			if(StateMachine::getInstance().isManualMode())
 			{
 				logger.log(LogLevel::INFO, "Stopping First test in manual Mode--->");
-				instance.stopTest(instance._testList[0].testType);
+				stopTest(_testList[0].testType);
 			}
 			else
 			{
 				logger.log(LogLevel::INFO, "Making Manager Wait--->");
-				instance.handleSyncCommand(SyncCommand::MANAGER_WAIT);
+				handleSyncCommand(SyncCommand::MANAGER_WAIT);
 			}
-			instance.acknowledgeCMD();
-			logger.log(LogLevel::INFO, "Clearing Stop bit after acknowledgement--->");
-			EventHelper::clearBits(UserCommandEvent::STOP);
-		}
-		else if((cmdResult & static_cast<EventBits_t>(UserCommandEvent::PAUSE)) != 0)
-		{
-			instance.UserStopTest();
-			instance.handleSyncCommand(SyncCommand::STOP_OBSERVER);
-			instance.handleSyncCommand(SyncCommand::MANAGER_WAIT);
-			instance.acknowledgeCMD();
-		}
-		else if((cmdResult & static_cast<EventBits_t>(UserCommandEvent::RESUME)) != 0)
-		{
-			instance.handleSyncCommand(SyncCommand::START_OBSERVER);
-			instance.handleSyncCommand(SyncCommand::MANAGER_ACTIVE);
-			instance.acknowledgeCMD();
-		}
-		vTaskDelay(pdMS_TO_TICKS(200));
+			acknowledgeCMD();
+			break;
+		case UserCommandEvent::PAUSE:
+			UserStopTest();
+			handleSyncCommand(SyncCommand::STOP_OBSERVER);
+			handleSyncCommand(SyncCommand::MANAGER_WAIT);
+			acknowledgeCMD();
+			break;
+		case UserCommandEvent::RESUME:
+			handleSyncCommand(SyncCommand::START_OBSERVER);
+			handleSyncCommand(SyncCommand::MANAGER_ACTIVE);
+			acknowledgeCMD();
+			break;
 	}
-	vTaskDelete(NULL);
 }
 
 void TestSync::userUpdateTask(void* pvParameters)
@@ -648,11 +650,13 @@ void TestSync::testSyncTask(void* pvParameters)
 						 pdMS_TO_TICKS(100)) == pdPASS)
 		{
 			logger.log(LogLevel::SUCCESS, "Switch Test data received");
+			Node_Utility::ModbusStatusServer::getInstance().publishResults(instance._swData);
 		}
 		else if(xQueueReceive(TestManager::getInstance().backupTestDataQueue, &instance._btData,
 							  pdMS_TO_TICKS(100)) == pdPASS)
 		{
 			logger.log(LogLevel::SUCCESS, "Backup Test data received");
+			Node_Utility::ModbusStatusServer::getInstance().publishResults(instance._btData);
 		}
 
 		vTaskDelay(pdMS_TO_TICKS(1500)); // General delay for task execution
@@ -23,6 +23,16 @@ extern StateMachine& stateMachine;
 
 const EventBits_t ALL_TEST_BITS = (1 << MAX_TEST) - 1;
 const EventBits_t ALL_CMD_BITS = (1 << MAX_USER_COMMAND) - 1;
+static constexpr size_t USER_COMMAND_QUEUE_SIZE = 8;
+
+// One user command on its way to the state machine; requestId 0 asks for no replies
+struct CommandRequest
+{
+	UserCommandEvent command = UserCommandEvent::STOP;
+	uint32_t requestId = 0;
+	int clientId = -1;
+	uint32_t received_us = 0;
+};
 
 class TestSync
 {
@@ -34,6 +44,8 @@ class TestSync
 
 	void parseIncomingJson(JsonVariant json);
 
+	// Hands a command to the command task without waiting; false when the queue is full
+	bool submitCommand(const CommandRequest& request);
 	void handleUserUpdate(UserUpdateEvent update);
 	void handleSyncCommand(SyncCommand command);
 
@@ -97,6 +109,9 @@ class TestSync
 	void addUniqueTest(const String& testName, const String& loadLevel);
 	void removeTest(const String& testName, const String& loadLevel);
 
+	void runCommand(UserCommandEvent command);
+
+	QueueHandle_t commandQueue = NULL;
 	TaskHandle_t commandObserverTaskHandle = nullptr;
 	TaskHandle_t updateObserverTaskHandle = nullptr;
 
@@ -68,6 +68,15 @@ void UPSTesterSetup::updateSettings(SettingType settingType, const void* newSett
 
 			break;
 
+		case SettingType::CALIBRATION:
+		{
+			const SetupCalibration previous = _calibrationSetting;
+			_calibrationSetting = *static_cast<const SetupCalibration*>(newSetting);
+			versionCalibration(previous);
+			notifyObservers(SettingType::CALIBRATION, &_calibrationSetting);
+		}
+		break;
+
 		case SettingType::ALL:
 			_allSetting = *static_cast<const SetupUPSTest*>(newSetting);
 
@@ -191,6 +200,24 @@ void UPSTesterSetup::serializeSettings(const char* filename)
 	doc["report"]["sampleNumber"] = _reportSetting.sampleNumber;
 	doc["report"]["lastsetting_updated"] = _reportSetting.lastUpdate();
 
+	doc["calibration"]["version"] = _calibrationSetting.version;
+	doc["calibration"]["lastsetting_updated"] = _calibrationSetting.lastsetting_updated;
+	JsonArray channels = doc["calibration"]["channels"].to<JsonArray>();
+	for(uint8_t i = 0; i < _calibrationSetting.channelCount; ++i)
+	{
+		const MeterCalibration& cal = _calibrationSetting.channels[i];
+		JsonObject channel = channels.add<JsonObject>();
+		channel["meterId"] = cal.meterId;
+		channel["ctRatio"] = cal.ctRatio;
+		JsonArray gain = channel["gain"].to<JsonArray>();
+		JsonArray offset = channel["offset"].to<JsonArray>();
+		for(size_t q = 0; q < MeterCalibration::QUANTITIES; ++q)
+		{
+			gain.add(cal.gain[q]);
+			offset.add(cal.offset[q]);
+		}
+	}
+
 	// Open file for writing
 	File file = LittleFS.open(filename, "w");
 	if(!file)
@@ -227,6 +254,11 @@ void UPSTesterSetup::deserializeSettings(const char* filename)
 	}
 	file.close();
 
+	applySettings(doc);
+}
+
+void UPSTesterSetup::applySettings(JsonVariant doc)
+{
 	// Read the JSON into the internal settings structures, retaining existing
 	// values as fallback
 	_spec.Rating_va = doc["spec"]["Rating_va"] | _spec.Rating_va;
@@ -303,6 +335,61 @@ void UPSTesterSetup::deserializeSettings(const char* filename)
 	_reportSetting.brandName = doc["report"]["brandName"] | _reportSetting.brandName;
 	_reportSetting.serialNumber = doc["report"]["serialNumber"] | _reportSetting.serialNumber;
 	_reportSetting.sampleNumber = doc["report"]["sampleNumber"] | _reportSetting.sampleNumber;
+
+	const SetupCalibration previousCalibration = _calibrationSetting;
+	_calibrationSetting.version = doc["calibration"]["version"] | _calibrationSetting.version;
+	_calibrationSetting.lastsetting_updated =
+		doc["calibration"]["lastsetting_updated"] | _calibrationSetting.lastsetting_updated;
+	JsonArray channels = doc["calibration"]["channels"];
+	if(!channels.isNull())
+	{
+		_calibrationSetting.channelCount = 0;
+		for(JsonObject channel: channels)
+		{
+			if(_calibrationSetting.channelCount == SetupCalibration::MAX_CHANNELS)
+				break;
+			MeterCalibration cal;
+			cal.meterId = channel["meterId"] | cal.meterId;
+			cal.ctRatio = channel["ctRatio"] | cal.ctRatio;
+			for(size_t q = 0; q < MeterCalibration::QUANTITIES; ++q)
+			{
+				cal.gain[q] = channel["gain"][q] | cal.gain[q];
+				cal.offset[q] = channel["offset"][q] | cal.offset[q];
+			}
+			_calibrationSetting.channels[_calibrationSetting.channelCount++] = cal;
+		}
+	}
+	versionCalibration(previousCalibration);
+}
+
+// Results record the version their readings were corrected with, so any change to the
+// coefficients that did not come with a newer version gets one here
+void UPSTesterSetup::versionCalibration(const SetupCalibration& previous)
+{
+	SetupCalibration& current = _calibrationSetting;
+	bool changed = current.channelCount != previous.channelCount;
+	for(uint8_t i = 0; !changed && i < current.channelCount && i < SetupCalibration::MAX_CHANNELS;
+		++i)
+	{
+		const MeterCalibration& a = current.channels[i];
+		const MeterCalibration& b = previous.channels[i];
+		changed = a.meterId != b.meterId || a.ctRatio != b.ctRatio ||
+				  memcmp(a.gain, b.gain, sizeof(a.gain)) != 0 ||
+				  memcmp(a.offset, b.offset, sizeof(a.offset)) != 0;
+	}
+	if(changed && current.version == previous.version)
+	{
+		current.version = previous.version + 1;
+		current.lastsetting_updated = millis();
+	}
+}
+
+void UPSTesterSetup::commitSettings()
+{
+	serializeSettings("/tester_settings.json");
+	notifyObservers(SettingType::SPEC, &_spec);
+	notifyObservers(SettingType::TEST, &_testSetting);
+	notifyObservers(SettingType::CALIBRATION, &_calibrationSetting);
 }
 
 // void UPSTesterSetup::loadFactorySettings() {
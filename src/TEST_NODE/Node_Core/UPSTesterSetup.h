@@ -3,6 +3,7 @@
 
 #include "Settings.h"
 #include <Arduino.h>
+#include <ArduinoJson.h>
 #include <IPAddress.h>
 #include <functional>
 #include <stdint.h>
@@ -51,6 +52,10 @@ class UPSTesterSetup : public SettingsSubject
 	{
 		return _TuningSetting;
 	};
+	const SetupCalibration& calibrationSetup()
+	{
+		return _calibrationSetting;
+	};
 
 	template<typename T, typename U, typename V>
 	bool setField(T& setup, const U Field, V Fieldvalue);
@@ -62,6 +67,10 @@ class UPSTesterSetup : public SettingsSubject
 
 	void serializeSettings(const char* filename);
 	void deserializeSettings(const char* filename);
+	// Any subset of the settings file layout; absent keys keep their current values
+	void applySettings(JsonVariant doc);
+	// Saves what applySettings changed and tells the observers
+	void commitSettings();
 
 	void notifySpecUpdated(const SetupSpec& newSpec, bool saveSetting)
 	{
@@ -90,9 +99,12 @@ class UPSTesterSetup : public SettingsSubject
 	SetupNetwork _networkSetting;
 	SetupModbus _modbusSetting;
 	SetupReport _reportSetting;
+	SetupCalibration _calibrationSetting;
 	SetupUPSTest _allSetting;
 
 	void notifyAllSettingsApplied();
+	// Bumps the version when the coefficients changed but the version did not
+	void versionCalibration(const SetupCalibration& previous);
 
 	UPSTesterSetup(const UPSTesterSetup&) = delete;
 	UPSTesterSetup& operator=(const UPSTesterSetup&) = delete;
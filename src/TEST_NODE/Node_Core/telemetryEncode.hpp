@@ -0,0 +1,158 @@
+#ifndef TELEMETRY_ENCODE_HPP
+#define TELEMETRY_ENCODE_HPP
+
+#include <ArduinoJson.h>
+#include <pb_encode.h>
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include "PZEM_Measure.hpp"
+#include "report.pb.h"
+#include "wsFrame.hpp"
+
+namespace Node_Core
+{
+static constexpr size_t TELEMETRY_CHANNELS = sizeof(pg_TelemetryFrame::channels) /
+											   sizeof(pg_TelemetryFrame::channels[0]);
+
+// Delta stream: a key frame every N frames, and in between only values that moved further than
+// their deadband from what clients were last sent
+static constexpr uint32_t TELEMETRY_KEY_FRAME_INTERVAL = 10;
+static constexpr float TELEMETRY_DEADBAND_VOLT = 0.5f;
+static constexpr float TELEMETRY_DEADBAND_AMP = 0.02f;
+static constexpr float TELEMETRY_DEADBAND_WATT = 2.0f;
+static constexpr float TELEMETRY_DEADBAND_PF = 0.01f;
+static constexpr float TELEMETRY_DEADBAND_HZ = 0.05f;
+
+// The JSON readings frame, one meter per side
+inline void fillReadingsJson(JsonDocument& doc, const OutBox& input, const OutBox& output)
+{
+	doc["inputCurrent"] = input.current;
+	doc["outputCurrent"] = output.current;
+	doc["inputVoltage"] = input.voltage;
+	doc["outputVoltage"] = output.voltage;
+	doc["inputPowerFactor"] = input.powerfactor;
+	doc["outputPowerFactor"] = output.powerfactor;
+	doc["inputWattage"] = input.power;
+	doc["outputWattage"] = output.power;
+}
+
+// Appends one meter to a binary frame; false once the frame is full
+inline bool addTelemetryChannel(pg_TelemetryFrame& frame, pg_PowerMeasureType type,
+								uint32_t meterId, const OutBox& measure)
+{
+	if(frame.channels_count >= TELEMETRY_CHANNELS)
+		return false;
+	pg_PowerMeasure& channel = frame.channels[frame.channels_count++];
+	channel.type = type;
+	channel.meter_id = meterId;
+	channel.voltage = measure.voltage;
+	channel.current = measure.current;
+	channel.power = measure.power;
+	channel.pf = measure.powerfactor;
+	channel.frequency = measure.frequency;
+	return true;
+}
+
+// Null with error set to nanopb's message when the frame does not encode
+inline SharedFrame encodeTelemetryFrame(const pg_TelemetryFrame& frame, const char*& error)
+{
+	SharedFrame buffer = std::make_shared<std::vector<uint8_t>>(pg_TelemetryFrame_size);
+	pb_ostream_t stream = pb_ostream_from_buffer(buffer->data(), buffer->size());
+	if(!pb_encode(&stream, pg_TelemetryFrame_fields, &frame))
+	{
+		error = PB_GET_ERROR(&stream);
+		return nullptr;
+	}
+	buffer->resize(stream.bytes_written);
+	return buffer;
+}
+
+// The shared delta stream. The baseline holds the values every delta client has applied.
+class DeltaTelemetry
+{
+  public:
+	// Turns a full frame into the stream's next one: a key frame when due or when the channel
+	// count changed, otherwise only the channels with a field past its deadband, compacted in
+	// place. Sets the frame's sequence.
+	void next(pg_TelemetryFrame& frame)
+	{
+		frame.sequence = ++_sequence;
+
+		bool keyFrame = _lastKeyFrame == 0 || frame.channels_count != _channels ||
+						frame.sequence - _lastKeyFrame >= TELEMETRY_KEY_FRAME_INTERVAL;
+		if(keyFrame)
+		{
+			frame.key_frame = true;
+			std::copy(frame.channels, frame.channels + frame.channels_count, _baseline.begin());
+			_channels = frame.channels_count;
+			_lastKeyFrame = frame.sequence;
+			return;
+		}
+
+		pb_size_t kept = 0;
+		for(pb_size_t i = 0; i < frame.channels_count; ++i)
+		{
+			pg_PowerMeasure delta = pg_PowerMeasure();
+			if(deltaChannel(frame.channels[i], _baseline[i], delta))
+				frame.channels[kept++] = delta;
+		}
+		frame.channels_count = kept;
+	}
+
+	// The stream as the other delta clients now hold it: the baseline the last frame left, under
+	// that frame's sequence so a client's next delta follows on. frame still holds the header
+	// next() gave it.
+	void keyFrame(pg_TelemetryFrame& frame) const
+	{
+		frame.key_frame = true;
+		frame.channels_count = _channels;
+		std::copy(_baseline.begin(), _baseline.begin() + _channels, frame.channels);
+	}
+
+	// Fills delta with the fields of current that left their deadband around baseline and moves
+	// baseline along with them; false when nothing did
+	static bool deltaChannel(const pg_PowerMeasure& current, pg_PowerMeasure& baseline,
+							 pg_PowerMeasure& delta)
+	{
+		struct Field
+		{
+			float pg_PowerMeasure::*value;
+			uint8_t tag;
+			float deadband;
+		};
+		static const Field fields[] = {
+			{&pg_PowerMeasure::voltage, pg_PowerMeasure_voltage_tag, TELEMETRY_DEADBAND_VOLT},
+			{&pg_PowerMeasure::current, pg_PowerMeasure_current_tag, TELEMETRY_DEADBAND_AMP},
+			{&pg_PowerMeasure::power, pg_PowerMeasure_power_tag, TELEMETRY_DEADBAND_WATT},
+			{&pg_PowerMeasure::pf, pg_PowerMeasure_pf_tag, TELEMETRY_DEADBAND_PF},
+			{&pg_PowerMeasure::frequency, pg_PowerMeasure_frequency_tag,
+			 TELEMETRY_DEADBAND_HZ}};
+
+		for(const Field& field: fields)
+		{
+			if(fabsf(current.*field.value - baseline.*field.value) > field.deadband)
+			{
+				delta.*field.value = current.*field.value;
+				baseline.*field.value = current.*field.value;
+				delta.changed |= 1u << field.tag;
+			}
+		}
+		if(delta.changed == 0)
+			return false;
+
+		delta.meter_id = current.meter_id;
+		return true;
+	}
+
+  private:
+	std::array<pg_PowerMeasure, TELEMETRY_CHANNELS> _baseline{};
+	pb_size_t _channels = 0;
+	uint32_t _sequence = 0;
+	uint32_t _lastKeyFrame = 0; // 0 until the first frame, which is always a key frame
+};
+
+} // namespace Node_Core
+
+#endif // TELEMETRY_ENCODE_HPP
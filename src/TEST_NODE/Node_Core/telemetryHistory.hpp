@@ -0,0 +1,198 @@
+#ifndef TELEMETRY_HISTORY_HPP
+#define TELEMETRY_HISTORY_HPP
+
+#include <Arduino.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
+#include <array>
+#include <cstdint>
+
+namespace Node_Core
+{
+static constexpr uint32_t HISTORY_SAMPLE_MS = 1000;
+static constexpr size_t HISTORY_SAMPLES = 600; // Ten minutes at HISTORY_SAMPLE_MS, 24 KB
+static constexpr size_t HISTORY_EVENTS = 64;
+// Input V, A, W, pf then output V, A, W, pf, as the JSON readings carry them
+static constexpr size_t HISTORY_VALUES = 8;
+
+struct HistorySample
+{
+	uint32_t t_ms = 0;
+	uint8_t state = 0; // Node_Core::State
+	std::array<float, HISTORY_VALUES> values{};
+};
+
+struct HistoryEvent
+{
+	uint32_t t_ms = 0;
+	bool mode = false; // value is a TestMode rather than a State
+	uint8_t value = 0;
+};
+
+// Rings of recent readings and state changes, so a client that connects mid-test can catch up.
+// Times are millis(); comparisons go through before() and survive the wrap as long as the ring
+// spans less than 24 days.
+class TelemetryHistory
+{
+  public:
+	TelemetryHistory()
+	{
+		historyMutex = xSemaphoreCreateMutex();
+		configASSERT(historyMutex);
+	}
+	TelemetryHistory(const TelemetryHistory&) = delete;
+	TelemetryHistory& operator=(const TelemetryHistory&) = delete;
+
+	// Keeps about one sample per HISTORY_SAMPLE_MS; false when this one was skipped
+	bool record(const HistorySample& sample)
+	{
+		xSemaphoreTake(historyMutex, portMAX_DELAY);
+		bool take = _samples.count == 0 || !before(sample.t_ms, _nextSample_ms);
+		if(take)
+		{
+			// Stays on its grid through jitter; starts a new one after a gap in the readings
+			uint32_t next = _nextSample_ms + HISTORY_SAMPLE_MS;
+			bool onGrid = _samples.count > 0 && !before(next, sample.t_ms);
+			_nextSample_ms = onGrid ? next : sample.t_ms + HISTORY_SAMPLE_MS;
+			_samples.push(sample);
+		}
+		xSemaphoreGive(historyMutex);
+		return take;
+	}
+
+	void recordEvent(uint32_t t_ms, bool mode, uint8_t value)
+	{
+		HistoryEvent event;
+		event.t_ms = t_ms;
+		event.mode = mode;
+		event.value = value;
+		xSemaphoreTake(historyMutex, portMAX_DELAY);
+		_events.push(event);
+		xSemaphoreGive(historyMutex);
+	}
+
+	// Averages the samples between from_ms and to_ms into buckets of step_ms counted from
+	// from_ms, skipping empty ones, and hands at most max of them to visit. from_ms moves to the
+	// end of the last bucket handed over; fewer than max buckets means the range is done.
+	template<typename Visit>
+	size_t read(uint32_t& from_ms, uint32_t to_ms, uint32_t step_ms, size_t max, Visit visit)
+	{
+		size_t buckets = 0;
+		xSemaphoreTake(historyMutex, portMAX_DELAY);
+		size_t i = _samples.lowerBound(from_ms);
+		while(i < _samples.count && buckets < max)
+		{
+			const HistorySample& first = _samples.at(i);
+			if(before(to_ms, first.t_ms))
+				break;
+
+			uint32_t bucketEnd = from_ms + ((first.t_ms - from_ms) / step_ms + 1) * step_ms;
+			HistorySample mean;
+			mean.t_ms = bucketEnd - step_ms;
+			size_t n = 0;
+			for(; i < _samples.count; ++i)
+			{
+				const HistorySample& sample = _samples.at(i);
+				if(!before(sample.t_ms, bucketEnd) || before(to_ms, sample.t_ms))
+					break;
+				for(size_t v = 0; v < HISTORY_VALUES; ++v)
+					mean.values[v] += sample.values[v];
+				mean.state = sample.state; // Last state seen in the bucket
+				++n;
+			}
+			for(size_t v = 0; v < HISTORY_VALUES; ++v)
+				mean.values[v] /= n;
+
+			visit(mean);
+			++buckets;
+			from_ms = bucketEnd;
+		}
+		xSemaphoreGive(historyMutex);
+		return buckets;
+	}
+
+	// Events with from_ms <= t < to_ms, oldest first
+	template<typename Visit>
+	void readEvents(uint32_t from_ms, uint32_t to_ms, Visit visit)
+	{
+		xSemaphoreTake(historyMutex, portMAX_DELAY);
+		for(size_t i = _events.lowerBound(from_ms); i < _events.count; ++i)
+		{
+			const HistoryEvent& event = _events.at(i);
+			if(!before(event.t_ms, to_ms))
+				break;
+			visit(event);
+		}
+		xSemaphoreGive(historyMutex);
+	}
+
+	size_t sampleCount()
+	{
+		xSemaphoreTake(historyMutex, portMAX_DELAY);
+		size_t count = _samples.count;
+		xSemaphoreGive(historyMutex);
+		return count;
+	}
+
+	// Time of the oldest sample still held, or now when there is none
+	uint32_t oldest()
+	{
+		xSemaphoreTake(historyMutex, portMAX_DELAY);
+		uint32_t t_ms = _samples.count > 0 ? _samples.at(0).t_ms : millis();
+		xSemaphoreGive(historyMutex);
+		return t_ms;
+	}
+
+  private:
+	template<typename T, size_t N>
+	struct Ring
+	{
+		std::array<T, N> items;
+		size_t head = 0; // Oldest
+		size_t count = 0;
+
+		void push(const T& item)
+		{
+			items[(head + count) % N] = item;
+			if(count < N)
+				++count;
+			else
+				head = (head + 1) % N;
+		}
+
+		const T& at(size_t i) const
+		{
+			return items[(head + i) % N];
+		}
+
+		// First entry not older than t_ms
+		size_t lowerBound(uint32_t t_ms) const
+		{
+			size_t low = 0;
+			size_t high = count;
+			while(low < high)
+			{
+				size_t mid = (low + high) / 2;
+				if(before(at(mid).t_ms, t_ms))
+					low = mid + 1;
+				else
+					high = mid;
+			}
+			return low;
+		}
+	};
+
+	static bool before(uint32_t a, uint32_t b)
+	{
+		return static_cast<int32_t>(a - b) < 0;
+	}
+
+	Ring<HistorySample, HISTORY_SAMPLES> _samples;
+	Ring<HistoryEvent, HISTORY_EVENTS> _events;
+	uint32_t _nextSample_ms = 0;
+	SemaphoreHandle_t historyMutex = NULL;
+};
+
+} // namespace Node_Core
+
+#endif // TELEMETRY_HISTORY_HPP
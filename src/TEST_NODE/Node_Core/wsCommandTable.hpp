@@ -0,0 +1,118 @@
+#ifndef WS_COMMAND_TABLE_HPP
+#define WS_COMMAND_TABLE_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include "wsDefines.hpp"
+
+namespace Node_Core
+{
+constexpr size_t wsLength(const char* text)
+{
+	size_t len = 0;
+	while(text[len] != '\0')
+		++len;
+	return len;
+}
+
+struct WsCommandName
+{
+	const char* text;
+	size_t len;
+	wsIncomingCommands cmd;
+
+	constexpr WsCommandName(const char* name, wsIncomingCommands command) :
+		text(name), len(wsLength(name)), cmd(command)
+	{
+	}
+};
+
+// Every text command the node accepts. Adding one may break the static_assert below; if so,
+// try other WS_COMMAND_SEED values, about one in thirty works for a table this full.
+static constexpr WsCommandName WS_COMMANDS[] = {
+	{"start", wsIncomingCommands::TEST_START},
+	{"stop", wsIncomingCommands::TEST_STOP},
+	{"pause", wsIncomingCommands::TEST_PAUSE},
+	{"AUTO", wsIncomingCommands::AUTO_MODE},
+	{"MANUAL", wsIncomingCommands::MANUAL_MODE},
+	{"Load On", wsIncomingCommands::LOAD_ON},
+	{"Load Off", wsIncomingCommands::LOAD_OFF},
+	{"Mains On", wsIncomingCommands::MAINS_ON},
+	{"Mains Off", wsIncomingCommands::MAINS_OFF},
+	{"getReadings", wsIncomingCommands::GET_READINGS},
+	{"format:pb", wsIncomingCommands::FORMAT_BINARY},
+	{"format:delta", wsIncomingCommands::FORMAT_DELTA},
+	{"format:json", wsIncomingCommands::FORMAT_JSON},
+	{"resync", wsIncomingCommands::TELEMETRY_RESYNC},
+};
+static constexpr size_t WS_COMMAND_COUNT = sizeof(WS_COMMANDS) / sizeof(WS_COMMANDS[0]);
+static constexpr size_t WS_COMMAND_SLOT_BITS = 5;
+static constexpr size_t WS_COMMAND_SLOTS = 1 << WS_COMMAND_SLOT_BITS;
+static constexpr uint32_t WS_COMMAND_SEED = 34;
+
+// Seeded FNV-1a; the slot comes from the top bits, the low bits of FNV mix too little
+constexpr uint32_t wsCommandHash(const char* text, size_t len, uint32_t seed)
+{
+	uint32_t hash = 2166136261UL ^ seed;
+	for(size_t i = 0; i < len; ++i)
+	{
+		hash ^= static_cast<uint8_t>(text[i]);
+		hash *= 16777619UL;
+	}
+	return hash;
+}
+
+constexpr size_t wsCommandSlot(const char* text, size_t len)
+{
+	return wsCommandHash(text, len, WS_COMMAND_SEED) >> (32 - WS_COMMAND_SLOT_BITS);
+}
+
+// Slot to WS_COMMANDS index, -1 for an empty slot and -2 where two names collide
+struct WsCommandSlots
+{
+	int8_t entry[WS_COMMAND_SLOTS];
+};
+
+constexpr WsCommandSlots buildWsCommandSlots()
+{
+	WsCommandSlots slots{};
+	for(size_t slot = 0; slot < WS_COMMAND_SLOTS; ++slot)
+		slots.entry[slot] = -1;
+	for(size_t i = 0; i < WS_COMMAND_COUNT; ++i)
+	{
+		size_t slot = wsCommandSlot(WS_COMMANDS[i].text, WS_COMMANDS[i].len);
+		slots.entry[slot] = slots.entry[slot] == -1 ? static_cast<int8_t>(i) : -2;
+	}
+	return slots;
+}
+
+constexpr bool isPerfect(const WsCommandSlots& slots)
+{
+	for(size_t slot = 0; slot < WS_COMMAND_SLOTS; ++slot)
+	{
+		if(slots.entry[slot] == -2)
+			return false;
+	}
+	return true;
+}
+
+static constexpr WsCommandSlots WS_COMMAND_TABLE = buildWsCommandSlots();
+static_assert(WS_COMMAND_COUNT < 128, "Slot entries are int8_t");
+static_assert(isPerfect(WS_COMMAND_TABLE), "WS_COMMAND_SEED maps two commands to one slot");
+
+// One hash and at most one memcmp; data need not be NUL-terminated
+inline const WsCommandName* findWsCommand(const char* data, size_t len)
+{
+	int8_t entry = WS_COMMAND_TABLE.entry[wsCommandSlot(data, len)];
+	if(entry < 0)
+		return nullptr;
+	const WsCommandName& command = WS_COMMANDS[entry];
+	if(command.len != len || memcmp(command.text, data, len) != 0)
+		return nullptr;
+	return &command;
+}
+
+} // namespace Node_Core
+
+#endif // WS_COMMAND_TABLE_HPP
@@ -15,6 +15,10 @@ enum class wsIncomingCommands
 	MAINS_ON,
 	MAINS_OFF,
 	GET_READINGS,
+	FORMAT_BINARY, // Switch this client's readings to nanopb TelemetryFrame
+	FORMAT_DELTA, // TelemetryFrame key frames plus deltas
+	FORMAT_JSON,
+	TELEMETRY_RESYNC, // Delta client saw a sequence gap; next frame is a key frame
 
 	INVALID_COMMAND // Handle invalid cases
 };
@@ -39,6 +43,13 @@ enum class wsPowerDataType
 	INVALID_DATA
 };
 
+enum class TelemetryFormat
+{
+	JSON,
+	BINARY,
+	DELTA
+};
+
 enum class wsOutGoingDataType
 {
 	POWER_READINGS,
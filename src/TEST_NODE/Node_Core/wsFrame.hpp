@@ -0,0 +1,70 @@
+#ifndef WS_FRAME_HPP
+#define WS_FRAME_HPP
+
+#include <ArduinoJson.h>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace Node_Core
+{
+// ESPAsyncWebServer's AsyncWebSocketSharedBuffer; every client queues the same buffer
+using SharedFrame = std::shared_ptr<std::vector<uint8_t>>;
+
+enum class FrameError : uint8_t
+{
+	NONE,
+	NO_DOCUMENT,
+	EMPTY_JSON,
+	TOO_LONG,
+	INVALID_UTF8
+};
+
+inline bool isValidUTF8(const char* data, size_t len)
+{
+	for(size_t i = 0; i < len; i++)
+	{
+		unsigned char c = static_cast<unsigned char>(data[i]);
+		if(c <= 0x7F)
+			continue; // ASCII
+		if((c >> 5) == 0x6)
+			i++; // 2-byte sequence
+		else if((c >> 4) == 0xE)
+			i += 2; // 3-byte sequence
+		else if((c >> 3) == 0x1E)
+			i += 3; // 4-byte sequence
+		else
+			return false; // Invalid UTF-8
+	}
+	return true;
+}
+
+// Serialize doc once into a frame of exactly its JSON, no terminator. frame is left null on
+// any error; limit bounds the JSON length, exclusive.
+inline FrameError encodeJsonFrame(const JsonDocument& doc, size_t limit, SharedFrame& frame)
+{
+	frame = nullptr;
+	if(doc.isNull())
+		return FrameError::NO_DOCUMENT;
+
+	size_t len = measureJson(doc);
+	if(len == 0)
+		return FrameError::EMPTY_JSON;
+	if(len >= limit)
+		return FrameError::TOO_LONG;
+
+	// One spare byte for the terminator serializeJson writes, dropped again afterwards
+	SharedFrame encoded = std::make_shared<std::vector<uint8_t>>(len + 1);
+	serializeJson(doc, reinterpret_cast<char*>(encoded->data()), encoded->size());
+	encoded->resize(len);
+
+	if(!isValidUTF8(reinterpret_cast<const char*>(encoded->data()), len))
+		return FrameError::INVALID_UTF8;
+	frame = std::move(encoded);
+	return FrameError::NONE;
+}
+
+} // namespace Node_Core
+
+#endif // WS_FRAME_HPP
@@ -0,0 +1,300 @@
+#ifndef WS_UPLOAD_HPP
+#define WS_UPLOAD_HPP
+
+#include <ArduinoJson.h>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <new>
+
+// Per-client reassembly arena. It has to hold one test of a plan, one section of a settings
+// object or a whole MessagePack upload.
+#ifndef WS_UPLOAD_ARENA_SIZE
+#define WS_UPLOAD_ARENA_SIZE 2048
+#endif
+// Largest upload accepted, counted over all of its frames
+#ifndef WS_UPLOAD_MAX_BYTES
+#define WS_UPLOAD_MAX_BYTES 32768
+#endif
+
+namespace Node_Core
+{
+static constexpr uint8_t WS_UPLOAD_NESTING_LIMIT = 10; // ArduinoJson's default
+
+// One WebSocket message too big for a command slot or split over several frames. Text is a JSON
+// array (a test plan, one object per test) or a JSON object (settings, laid out as the settings
+// file). Both are cut at their top-level commas while the bytes arrive, and every element is
+// parsed and handed on as soon as it closes, so the arena only ever holds the element in
+// progress. Binary is MessagePack of the same two shapes; it has no cheap split points and is
+// parsed once the whole message is in.
+class WsUpload
+{
+  public:
+	enum class Kind : uint8_t
+	{
+		UNKNOWN, // Nothing but whitespace seen yet
+		PLAN,
+		SETTINGS
+	};
+
+	enum class Status : uint8_t
+	{
+		OK,
+		TOO_LARGE, // Element longer than the arena or upload over WS_UPLOAD_MAX_BYTES
+		BAD_FORMAT,
+		NO_MEMORY
+	};
+
+	WsUpload() = default;
+	WsUpload(const WsUpload&) = delete;
+	WsUpload& operator=(const WsUpload&) = delete;
+
+	// Called on the first frame of a message; drops whatever was left of the previous one
+	Status begin(bool binary)
+	{
+		reset();
+		_arena.reset(new(std::nothrow) char[WS_UPLOAD_ARENA_SIZE]);
+		if(!_arena)
+			return Status::NO_MEMORY;
+		_binary = binary;
+		return Status::OK;
+	}
+
+	void reset()
+	{
+		_arena.reset();
+		_binary = false;
+		_kind = Kind::UNKNOWN;
+		_used = 0;
+		_scan = 0;
+		_start = 0;
+		_depth = 0;
+		_inString = false;
+		_escape = false;
+		_closed = false;
+		_received = 0;
+		_elements = 0;
+	}
+
+	bool active() const
+	{
+		return static_cast<bool>(_arena);
+	}
+	Kind kind() const
+	{
+		return _kind;
+	}
+	size_t received() const
+	{
+		return _received;
+	}
+	uint16_t elements() const
+	{
+		return _elements;
+	}
+
+	// Takes the next piece of the message; last marks its final byte. sink(kind, element) runs
+	// once per test object or settings section, on a document that is reused afterwards.
+	template<typename Sink>
+	Status feed(const uint8_t* data, size_t len, bool last, Sink&& sink)
+	{
+		if(!active())
+			return Status::BAD_FORMAT;
+		_received += len;
+		if(_received > WS_UPLOAD_MAX_BYTES)
+			return Status::TOO_LARGE;
+
+		JsonDocument doc;
+		if(_binary)
+			return feedMsgPack(data, len, last, doc, sink);
+
+		while(len > 0)
+		{
+			size_t room = WS_UPLOAD_ARENA_SIZE - _used;
+			if(room == 0)
+				return Status::TOO_LARGE;
+			size_t take = len < room ? len : room;
+			memcpy(_arena.get() + _used, data, take);
+			_used += take;
+			data += take;
+			len -= take;
+
+			Status status = scan(doc, sink);
+			if(status != Status::OK)
+				return status;
+			compact();
+		}
+		if(last && !_closed)
+			return Status::BAD_FORMAT;
+		return Status::OK;
+	}
+
+  private:
+	std::unique_ptr<char[]> _arena;
+	bool _binary = false;
+	Kind _kind = Kind::UNKNOWN;
+	size_t _used = 0; // Bytes held in the arena
+	size_t _scan = 0; // First byte not yet scanned
+	size_t _start = 0; // Opening bracket or comma before the element in progress
+	uint8_t _depth = 0;
+	bool _inString = false;
+	bool _escape = false;
+	bool _closed = false; // Top-level bracket closed; only whitespace may follow
+	size_t _received = 0;
+	uint16_t _elements = 0;
+
+	template<typename Sink>
+	Status feedMsgPack(const uint8_t* data, size_t len, bool last, JsonDocument& doc, Sink& sink)
+	{
+		if(len > WS_UPLOAD_ARENA_SIZE - _used)
+			return Status::TOO_LARGE;
+		memcpy(_arena.get() + _used, data, len);
+		_used += len;
+		if(!last)
+			return Status::OK;
+
+		if(deserializeMsgPack(doc, _arena.get(), _used))
+			return Status::BAD_FORMAT;
+		if(doc.is<JsonArray>())
+		{
+			_kind = Kind::PLAN;
+			for(JsonVariant element: doc.as<JsonArray>())
+			{
+				_elements++;
+				sink(_kind, element);
+			}
+		}
+		else if(doc.is<JsonObject>())
+		{
+			_kind = Kind::SETTINGS;
+			_elements++;
+			sink(_kind, doc.as<JsonVariant>());
+		}
+		else
+		{
+			return Status::BAD_FORMAT;
+		}
+		_closed = true;
+		return Status::OK;
+	}
+
+	// Walks the new bytes, tracking strings and nesting, and emits each element at the comma or
+	// bracket that ends it
+	template<typename Sink>
+	Status scan(JsonDocument& doc, Sink& sink)
+	{
+		char* arena = _arena.get();
+		for(; _scan < _used; ++_scan)
+		{
+			char c = arena[_scan];
+			if(_inString)
+			{
+				if(_escape)
+					_escape = false;
+				else if(c == '\\')
+					_escape = true;
+				else if(c == '"')
+					_inString = false;
+				continue;
+			}
+			if(isSpace(c))
+				continue;
+			if(_closed)
+				return Status::BAD_FORMAT;
+
+			if(_kind == Kind::UNKNOWN)
+			{
+				if(c != '[' && c != '{')
+					return Status::BAD_FORMAT;
+				_kind = c == '[' ? Kind::PLAN : Kind::SETTINGS;
+				_start = _scan;
+				_depth = 1;
+				continue;
+			}
+
+			if(c == '"')
+			{
+				_inString = true;
+			}
+			else if(c == '[' || c == '{')
+			{
+				if(++_depth > WS_UPLOAD_NESTING_LIMIT)
+					return Status::BAD_FORMAT;
+			}
+			else if(c == ']' || c == '}')
+			{
+				if(--_depth == 0)
+				{
+					Status status = emit(doc, sink);
+					if(status != Status::OK)
+						return status;
+					_closed = true;
+				}
+			}
+			else if(c == ',' && _depth == 1)
+			{
+				Status status = emit(doc, sink);
+				if(status != Status::OK)
+					return status;
+				_start = _scan;
+			}
+		}
+		return Status::OK;
+	}
+
+	// The element runs from after _start up to _scan. A settings member is parsed in place as
+	// a one-member object by borrowing the delimiters on both sides of it.
+	template<typename Sink>
+	Status emit(JsonDocument& doc, Sink& sink)
+	{
+		char* arena = _arena.get();
+		size_t first = _start + 1;
+		while(first < _scan && isSpace(arena[first]))
+			++first;
+		if(first == _scan)
+			return Status::OK; // "[]", "{}"
+
+		DeserializationError error;
+		if(_kind == Kind::PLAN)
+		{
+			error = deserializeJson(doc, static_cast<const char*>(arena + first), _scan - first);
+		}
+		else
+		{
+			char closing = arena[_scan];
+			arena[_start] = '{';
+			arena[_scan] = '}';
+			error = deserializeJson(doc, static_cast<const char*>(arena + _start),
+									_scan - _start + 1);
+			arena[_scan] = closing;
+		}
+		if(error)
+			return Status::BAD_FORMAT;
+
+		_elements++;
+		sink(_kind, doc.as<JsonVariant>());
+		return Status::OK;
+	}
+
+	// Drops everything before the element in progress
+	void compact()
+	{
+		if(_start == 0)
+			return;
+		size_t keep = _closed ? 0 : _used - _start;
+		memmove(_arena.get(), _arena.get() + _used - keep, keep);
+		_scan -= _used - keep;
+		_start = 0;
+		_used = keep;
+	}
+
+	static bool isSpace(char c)
+	{
+		return c == ' ' || c == '\t' || c == '\r' || c == '\n';
+	}
+};
+
+} // namespace Node_Core
+
+#endif // WS_UPLOAD_HPP
@@ -0,0 +1,229 @@
+#ifndef METER_REGISTRY_HPP
+#define METER_REGISTRY_HPP
+
+#include <Arduino.h>
+#include <array>
+#include <cstdint>
+#include "PZEM_Measure.hpp"
+#include "Settings.h"
+
+namespace Node_Utility
+{
+enum class MeterRole
+{
+	INPUT, // Mains side of the UPS
+	OUTPUT, // Load side of the UPS
+	BYPASS, // Static/maintenance bypass line
+	BATTERY_DC // Battery string, usually a PZEM-003
+};
+
+// Fixed-capacity meter table. Measurements live in one contiguous array indexed by slot, and
+// meter ids map to slots through a 256 entry table, so lookups never search.
+class MeterRegistry
+{
+  public:
+	static constexpr size_t MAX_METERS = 32;
+	static constexpr uint8_t NO_METER = 0xFF; // Matches NamePlate's unset id
+	static constexpr uint8_t NO_SLOT = 0xFF;
+
+	struct MeterInfo
+	{
+		Node_Core::NamePlate plate;
+		MeterRole role = MeterRole::INPUT;
+		uint32_t lastUpdate_ms = 0;
+		uint32_t updates = 0;
+		uint16_t calibrationVersion = 0; // 0 while the meter reads uncorrected
+	};
+
+	MeterRegistry()
+	{
+		_slotById.fill(static_cast<uint8_t>(NO_SLOT)); // Copy, fill() binds by reference
+	}
+
+	// Returns false when the id is unset, already taken or the table is full
+	bool add(const Node_Core::NamePlate& plate, MeterRole role)
+	{
+		if(plate.id == NO_METER || _slotById[plate.id] != NO_SLOT || _count >= MAX_METERS)
+		{
+			return false;
+		}
+
+		uint8_t slot = static_cast<uint8_t>(_count++);
+		_slotById[plate.id] = slot;
+		_info[slot] = MeterInfo();
+		_info[slot].plate = plate;
+		_info[slot].role = role;
+		_measures[slot] = Node_Core::OutBox();
+		_calibration[slot] = Coefficients();
+		return true;
+	}
+
+	// Folds each meter's channel (CT ratio into gain) so publish() is one multiply-add per
+	// field. Meters without a channel go back to identity.
+	void setCalibration(const Node_Core::SetupCalibration& setup)
+	{
+		using Node_Core::MeterCalibration;
+		for(size_t i = 0; i < _count; ++i)
+		{
+			Coefficients coefficients;
+			const MeterCalibration* channel = setup.channel(_info[i].plate.id);
+			if(channel != nullptr)
+			{
+				for(size_t q = 0; q < MeterCalibration::QUANTITIES; ++q)
+				{
+					float ct = usesCtRatio(q) ? channel->ctRatio : 1.0f;
+					coefficients.gain[q] = channel->gain[q] * ct;
+					coefficients.offset[q] = channel->offset[q];
+				}
+			}
+			_calibration[i] = coefficients;
+			_info[i].calibrationVersion = channel != nullptr ? setup.version : 0;
+		}
+	}
+
+	// Calibration stage between the parsed registers and the published measurement. The
+	// reading is corrected on the caller's copy and stored in one assignment, so the slot never
+	// holds raw or half-corrected values. False when the meter is not registered.
+	bool publish(uint8_t meterId, Node_Core::OutBox box)
+	{
+		uint8_t slot = _slotById[meterId];
+		if(slot == NO_SLOT)
+			return false;
+
+		using Node_Core::OutBox;
+		// Same order as MeterCalibration::Quantity
+		static float OutBox::* const fields[Node_Core::MeterCalibration::QUANTITIES] = {
+			&OutBox::voltage, &OutBox::current,	  &OutBox::power,
+			&OutBox::energy,  &OutBox::frequency, &OutBox::powerfactor};
+
+		const Coefficients& coefficients = _calibration[slot];
+		for(size_t q = 0; q < Node_Core::MeterCalibration::QUANTITIES; ++q)
+		{
+			box.*fields[q] = box.*fields[q] * coefficients.gain[q] + coefficients.offset[q];
+		}
+		box.calibrationVersion = _info[slot].calibrationVersion;
+
+		_measures[slot] = box;
+		_info[slot].lastUpdate_ms = millis();
+		_info[slot].updates++;
+		return true;
+	}
+
+	bool contains(uint8_t meterId) const
+	{
+		return _slotById[meterId] != NO_SLOT;
+	}
+
+	Node_Core::OutBox* measure(uint8_t meterId)
+	{
+		uint8_t slot = _slotById[meterId];
+		return slot == NO_SLOT ? nullptr : &_measures[slot];
+	}
+
+	const MeterInfo* info(uint8_t meterId) const
+	{
+		uint8_t slot = _slotById[meterId];
+		return slot == NO_SLOT ? nullptr : &_info[slot];
+	}
+
+	// First meter registered for the role and phase, NO_METER if none
+	uint8_t find(MeterRole role, Node_Core::Phase phase) const
+	{
+		for(size_t i = 0; i < _count; ++i)
+		{
+			if(_info[i].role == role && _info[i].plate.phase == phase)
+				return _info[i].plate.id;
+		}
+		return NO_METER;
+	}
+
+	// Single-phase meter for the role, else its red phase
+	uint8_t primary(MeterRole role) const
+	{
+		uint8_t id = find(role, Node_Core::Phase::SINGLE_PHASE);
+		return id != NO_METER ? id : find(role, Node_Core::Phase::RED_PHASE);
+	}
+
+	// Whole-role view of a three-phase (or single-phase) group: power and energy add up,
+	// voltage, current and frequency are phase averages and pf is total P over total S.
+	Node_Core::OutBox aggregate(MeterRole role) const
+	{
+		Node_Core::OutBox total;
+		float apparent = 0;
+		size_t phases = 0;
+		bool valid = true;
+
+		for(size_t i = 0; i < _count; ++i)
+		{
+			if(_info[i].role != role)
+				continue;
+
+			const Node_Core::OutBox& m = _measures[i];
+			total.voltage += m.voltage;
+			total.current += m.current;
+			total.frequency += m.frequency;
+			total.power += m.power;
+			total.energy += m.energy;
+			apparent += m.voltage * m.current;
+			valid = valid && m.isValid;
+			// Mixed versions report 0, same as uncorrected
+			if(phases == 0)
+				total.calibrationVersion = m.calibrationVersion;
+			else if(total.calibrationVersion != m.calibrationVersion)
+				total.calibrationVersion = 0;
+			phases++;
+		}
+
+		if(phases == 0)
+			return total;
+
+		total.voltage /= phases;
+		total.current /= phases;
+		total.frequency /= phases;
+		total.powerfactor = apparent > 0 ? total.power / apparent : 0;
+		total.isValid = valid;
+		total.type = role == MeterRole::OUTPUT ? Node_Core::MeasureType::OUTPUT_POWER
+											   : Node_Core::MeasureType::INPUT_POWER;
+		return total;
+	}
+
+	size_t size() const
+	{
+		return _count;
+	}
+
+	// Slot-order access for reporting loops
+	const Node_Core::OutBox& measureAt(size_t slot) const
+	{
+		return _measures[slot];
+	}
+	const MeterInfo& infoAt(size_t slot) const
+	{
+		return _info[slot];
+	}
+
+  private:
+	struct Coefficients
+	{
+		float gain[Node_Core::MeterCalibration::QUANTITIES] = {1.0f, 1.0f, 1.0f, 1.0f, 1.0f, 1.0f};
+		float offset[Node_Core::MeterCalibration::QUANTITIES] = {0, 0, 0, 0, 0, 0};
+	};
+
+	std::array<Node_Core::OutBox, MAX_METERS> _measures;
+	std::array<MeterInfo, MAX_METERS> _info;
+	std::array<Coefficients, MAX_METERS> _calibration;
+	std::array<uint8_t, 256> _slotById;
+	size_t _count = 0;
+
+	// Current, power and energy scale with the CT ratio; voltage, frequency and pf do not
+	static bool usesCtRatio(size_t quantity)
+	{
+		using Quantity = Node_Core::MeterCalibration::Quantity;
+		Quantity q = static_cast<Quantity>(quantity);
+		return q == Quantity::Current || q == Quantity::Power || q == Quantity::Energy;
+	}
+};
+
+} // namespace Node_Utility
+
+#endif // METER_REGISTRY_HPP
@@ -0,0 +1,313 @@
+#ifndef MODBUS_CLIENT_POOL_HPP
+#define MODBUS_CLIENT_POOL_HPP
+
+#include <ModbusClientTCP.h>
+#include <IPAddress.h>
+#include <WiFiClient.h>
+#include <lwip/sockets.h>
+#include <Arduino.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <memory>
+#include <cstdint>
+
+namespace Node_Utility
+{
+// One persistent ModbusClientTCP per server endpoint. eModbus drops the connection whenever
+// setTarget() switches host, so sharing a single client between servers reconnects on every
+// alternation; here each endpoint keeps its own socket and worker task.
+class ModbusTcpPool
+{
+  public:
+	static constexpr size_t MAX_ENDPOINTS = 4;
+	static constexpr uint32_t IDLE_EVICT_MS = 60000;
+	static constexpr uint32_t BACKOFF_BASE_MS = 500;
+	static constexpr uint32_t BACKOFF_MAX_MS = 30000;
+	static constexpr int KEEPALIVE_IDLE_S = 5;
+	static constexpr int KEEPALIVE_INTERVAL_S = 2;
+	static constexpr int KEEPALIVE_COUNT = 3;
+
+	struct Stats
+	{
+		uint32_t opened = 0; // Clients created for a new endpoint
+		uint32_t evicted = 0; // Clients closed after IDLE_EVICT_MS without traffic
+		uint32_t connects = 0; // TCP connections seen coming up
+		uint32_t drops = 0; // TCP connections seen going down while pooled
+		uint32_t connectFailures = 0; // IP_CONNECTION_FAILED reported by eModbus
+		uint32_t deferred = 0; // Requests refused while an endpoint was backing off
+	};
+
+	ModbusTcpPool()
+	{
+		poolMutex = xSemaphoreCreateMutex();
+		configASSERT(poolMutex);
+	}
+	ModbusTcpPool(const ModbusTcpPool&) = delete;
+	ModbusTcpPool& operator=(const ModbusTcpPool&) = delete;
+
+	void setTimeout(uint32_t timeout, uint32_t interval)
+	{
+		_timeout = timeout;
+		_interval = interval;
+	}
+	void onDataHandler(MBOnData handler)
+	{
+		_onData = handler;
+	}
+	void onErrorHandler(MBOnError handler)
+	{
+		_onError = handler;
+	}
+
+	// timeout_ms overrides the pool default for this request only; eModbus latches the
+	// target, including its timeout, into each queued request. deferred is set when the
+	// request was held back during the endpoint's backoff: nothing was sent, so the failure
+	// that started the backoff must not be counted again.
+	Modbus::Error addRequest(IPAddress ip, uint16_t port, const ModbusMessage& request,
+							 uint32_t token, uint32_t timeout_ms, bool& deferred)
+	{
+		deferred = false;
+		xSemaphoreTake(poolMutex, portMAX_DELAY);
+		Modbus::Error error = Modbus::Error::REQUEST_QUEUE_FULL;
+		Endpoint* endpoint = acquire(ip, port);
+		if(endpoint != nullptr)
+		{
+			uint32_t now = millis();
+			if(endpoint->failures > 0 && static_cast<int32_t>(endpoint->retryAt_ms - now) > 0)
+			{
+				_stats.deferred++;
+				deferred = true;
+				error = Modbus::Error::IP_CONNECTION_FAILED;
+			}
+			else
+			{
+				endpoint->lastUsed_ms = now;
+				// Same host and port as the client's own, so this never forces a reconnect
+				endpoint->client->setTarget(ip, port, timeout_ms != 0 ? timeout_ms : _timeout,
+											_interval);
+				error = endpoint->client->addRequest(request, token);
+			}
+		}
+		xSemaphoreGive(poolMutex);
+		return error;
+	}
+
+	// Connection-level failures back the endpoint off exponentially; any reply clears it
+	void reportFailure(IPAddress ip, uint16_t port)
+	{
+		xSemaphoreTake(poolMutex, portMAX_DELAY);
+		Endpoint* endpoint = find(ip, port);
+		if(endpoint != nullptr)
+		{
+			_stats.connectFailures++;
+			if(endpoint->failures < 16)
+				endpoint->failures++;
+			uint32_t backoff = BACKOFF_BASE_MS << (endpoint->failures - 1);
+			if(backoff > BACKOFF_MAX_MS)
+				backoff = BACKOFF_MAX_MS;
+			endpoint->retryAt_ms = millis() + backoff;
+		}
+		xSemaphoreGive(poolMutex);
+	}
+
+	void reportSuccess(IPAddress ip, uint16_t port)
+	{
+		xSemaphoreTake(poolMutex, portMAX_DELAY);
+		Endpoint* endpoint = find(ip, port);
+		if(endpoint != nullptr)
+			endpoint->failures = 0;
+		xSemaphoreGive(poolMutex);
+	}
+
+	// Called from the polling loop: collects connection churn and evicts endpoints that have
+	// gone quiet. The sockets themselves are only touched by their eModbus worker.
+	void maintain()
+	{
+		xSemaphoreTake(poolMutex, portMAX_DELAY);
+		uint32_t now = millis();
+
+		for(auto& endpoint: _endpoints)
+		{
+			if(!endpoint.client)
+				continue;
+
+			_stats.connects += endpoint.socket.connects.exchange(0);
+			_stats.drops += endpoint.socket.drops.exchange(0);
+
+			bool idle = now - endpoint.lastUsed_ms > IDLE_EVICT_MS;
+			if(idle && endpoint.client->pendingRequests() == 0)
+			{
+				Serial.printf("Modbus pool: evicting idle endpoint %s:%u\n",
+							  endpoint.ip.toString().c_str(), endpoint.port);
+				release(endpoint);
+				_stats.evicted++;
+			}
+		}
+		xSemaphoreGive(poolMutex);
+	}
+
+	uint32_t pendingRequests()
+	{
+		uint32_t pending = 0;
+		xSemaphoreTake(poolMutex, portMAX_DELAY);
+		for(auto& endpoint: _endpoints)
+		{
+			if(endpoint.client)
+				pending += endpoint.client->pendingRequests();
+		}
+		xSemaphoreGive(poolMutex);
+		return pending;
+	}
+
+	size_t activeEndpoints() const
+	{
+		size_t count = 0;
+		for(const auto& endpoint: _endpoints)
+		{
+			if(endpoint.client)
+				count++;
+		}
+		return count;
+	}
+
+	const Stats& stats() const
+	{
+		return _stats;
+	}
+
+  private:
+	// eModbus connects and disconnects from its worker task, so keep-alive is armed right
+	// there on the new socket, and churn is counted for maintain() to collect
+	class PooledSocket : public WiFiClient
+	{
+	  public:
+		std::atomic<uint32_t> connects{0};
+		std::atomic<uint32_t> drops{0};
+
+		using WiFiClient::connect;
+		int connect(IPAddress ip, uint16_t port) override
+		{
+			int result = WiFiClient::connect(ip, port);
+			if(result)
+			{
+				enableKeepAlive(*this);
+				_up = true;
+				connects++;
+			}
+			return result;
+		}
+
+		void stop() override
+		{
+			if(_up.exchange(false))
+				drops++;
+			WiFiClient::stop();
+		}
+
+		// Closed by the pool itself, which is not a drop
+		void close()
+		{
+			_up = false;
+			WiFiClient::stop();
+		}
+
+	  private:
+		std::atomic<bool> _up{false};
+	};
+
+	struct Endpoint
+	{
+		IPAddress ip;
+		uint16_t port = 0;
+		PooledSocket socket; // Referenced by client, so endpoints never move
+		std::unique_ptr<ModbusClientTCP> client;
+		uint32_t lastUsed_ms = 0;
+		uint32_t retryAt_ms = 0;
+		uint8_t failures = 0;
+	};
+
+	std::array<Endpoint, MAX_ENDPOINTS> _endpoints;
+	Stats _stats;
+	SemaphoreHandle_t poolMutex = NULL; // Guards the endpoint table
+	uint32_t _timeout = 4000;
+	uint32_t _interval = 2000;
+	MBOnData _onData;
+	MBOnError _onError;
+
+	// Callers hold poolMutex
+	Endpoint* find(IPAddress ip, uint16_t port)
+	{
+		for(auto& endpoint: _endpoints)
+		{
+			if(endpoint.client && endpoint.ip == ip && endpoint.port == port)
+				return &endpoint;
+		}
+		return nullptr;
+	}
+
+	Endpoint* acquire(IPAddress ip, uint16_t port)
+	{
+		Endpoint* endpoint = find(ip, port);
+		if(endpoint != nullptr)
+			return endpoint;
+
+		for(auto& slot: _endpoints)
+		{
+			if(!slot.client)
+			{
+				open(slot, ip, port);
+				return &slot;
+			}
+		}
+
+		Serial.printf("Modbus pool: no free slot for %s:%u\n", ip.toString().c_str(), port);
+		return nullptr;
+	}
+
+	void open(Endpoint& endpoint, IPAddress ip, uint16_t port)
+	{
+		endpoint.ip = ip;
+		endpoint.port = port;
+		endpoint.lastUsed_ms = millis();
+		endpoint.retryAt_ms = 0;
+		endpoint.failures = 0;
+		endpoint.socket.connects = 0;
+		endpoint.socket.drops = 0;
+
+		endpoint.client =
+			std::unique_ptr<ModbusClientTCP>(new ModbusClientTCP(endpoint.socket, ip, port));
+		endpoint.client->setTimeout(_timeout, _interval);
+		endpoint.client->onDataHandler(_onData);
+		endpoint.client->onErrorHandler(_onError);
+		endpoint.client->begin();
+		_stats.opened++;
+
+		Serial.printf("Modbus pool: opened endpoint %s:%u\n", ip.toString().c_str(), port);
+	}
+
+	void release(Endpoint& endpoint)
+	{
+		endpoint.client.reset(); // Stops the worker task and closes the connection
+		endpoint.socket.close();
+	}
+
+	static void enableKeepAlive(WiFiClient& socket)
+	{
+		int enable = 1;
+		int idle = KEEPALIVE_IDLE_S;
+		int interval = KEEPALIVE_INTERVAL_S;
+		int count = KEEPALIVE_COUNT;
+		socket.setSocketOption(SO_KEEPALIVE, reinterpret_cast<char*>(&enable), sizeof(enable));
+		socket.setOption(TCP_KEEPIDLE, &idle);
+		socket.setOption(TCP_KEEPINTVL, &interval);
+		socket.setOption(TCP_KEEPCNT, &count);
+		socket.setNoDelay(true);
+	}
+};
+
+} // namespace Node_Utility
+
+#endif // MODBUS_CLIENT_POOL_HPP
@@ -0,0 +1,177 @@
+#ifndef MODBUS_HEALTH_HPP
+#define MODBUS_HEALTH_HPP
+
+#include <Arduino.h>
+#include <cstdint>
+
+namespace Node_Utility
+{
+// Jacobson/Karels round-trip estimator, as TCP uses for its retransmission timer:
+// SRTT += (R - SRTT) / 8, RTTVAR += (|R - SRTT| - RTTVAR) / 4, RTO = SRTT + 4 * RTTVAR.
+// A timeout doubles the RTO until the next clean sample (Karn's backoff).
+class RttEstimator
+{
+  public:
+	static constexpr uint32_t MIN_RTO_MS = 250;
+
+	void setBounds(uint32_t initial_ms, uint32_t max_ms)
+	{
+		_max_ms = max_ms > MIN_RTO_MS ? max_ms : MIN_RTO_MS;
+		if(!_hasSample)
+			_rto_ms = clamp(initial_ms);
+	}
+
+	void onSample(uint32_t rtt_us)
+	{
+		int32_t rtt = static_cast<int32_t>(rtt_us);
+		if(!_hasSample)
+		{
+			_srtt_us = rtt;
+			_rttvar_us = rtt / 2;
+			_hasSample = true;
+		}
+		else
+		{
+			int32_t error = rtt - _srtt_us;
+			_srtt_us += error / 8;
+			_rttvar_us += ((error < 0 ? -error : error) - _rttvar_us) / 4;
+		}
+		_rto_ms = clamp((_srtt_us + 4 * _rttvar_us + 999) / 1000);
+	}
+
+	void onTimeout()
+	{
+		_rto_ms = clamp(_rto_ms * 2);
+	}
+
+	uint32_t rtoMs() const
+	{
+		return _rto_ms;
+	}
+	uint32_t srttUs() const
+	{
+		return static_cast<uint32_t>(_srtt_us);
+	}
+	uint32_t rttvarUs() const
+	{
+		return static_cast<uint32_t>(_rttvar_us);
+	}
+
+  private:
+	int32_t _srtt_us = 0;
+	int32_t _rttvar_us = 0;
+	uint32_t _rto_ms = 1000;
+	uint32_t _max_ms = 4000;
+	bool _hasSample = false;
+
+	uint32_t clamp(uint32_t rto_ms) const
+	{
+		if(rto_ms < MIN_RTO_MS)
+			return MIN_RTO_MS;
+		return rto_ms > _max_ms ? _max_ms : rto_ms;
+	}
+};
+
+// Stops polling a device after repeated failures. OPEN waits out a cooldown that doubles on
+// every failed probe; HALF_OPEN lets exactly one probe through and closes on its success.
+class CircuitBreaker
+{
+  public:
+	enum class State : uint8_t
+	{
+		CLOSED,
+		OPEN,
+		HALF_OPEN
+	};
+
+	static constexpr uint8_t FAILURE_THRESHOLD = 3;
+	static constexpr uint32_t BASE_COOLDOWN_MS = 2000;
+	static constexpr uint32_t MAX_COOLDOWN_MS = 60000;
+
+	bool allowRequest()
+	{
+		if(_state == State::CLOSED)
+			return true;
+
+		if(_state == State::OPEN)
+		{
+			if(static_cast<int32_t>(millis() - _openUntil_ms) < 0)
+				return false;
+			_state = State::HALF_OPEN;
+			_probeInFlight = false;
+		}
+
+		if(_probeInFlight)
+			return false;
+		_probeInFlight = true;
+		return true;
+	}
+
+	// The probe allowRequest() granted was never sent
+	void cancelProbe()
+	{
+		_probeInFlight = false;
+	}
+
+	void onSuccess()
+	{
+		_state = State::CLOSED;
+		_failures = 0;
+		_cooldown_ms = BASE_COOLDOWN_MS;
+		_probeInFlight = false;
+	}
+
+	void onFailure()
+	{
+		if(_state == State::HALF_OPEN)
+		{
+			_cooldown_ms = _cooldown_ms * 2 > MAX_COOLDOWN_MS ? MAX_COOLDOWN_MS : _cooldown_ms * 2;
+			open();
+			return;
+		}
+
+		if(_state == State::CLOSED && ++_failures >= FAILURE_THRESHOLD)
+		{
+			open();
+		}
+	}
+
+	State state() const
+	{
+		return _state;
+	}
+	uint32_t trips() const
+	{
+		return _trips;
+	}
+	uint32_t cooldownMs() const
+	{
+		return _cooldown_ms;
+	}
+
+  private:
+	State _state = State::CLOSED;
+	uint8_t _failures = 0;
+	bool _probeInFlight = false;
+	uint32_t _cooldown_ms = BASE_COOLDOWN_MS;
+	uint32_t _openUntil_ms = 0;
+	uint32_t _trips = 0;
+
+	void open()
+	{
+		_state = State::OPEN;
+		_openUntil_ms = millis() + _cooldown_ms;
+		_probeInFlight = false;
+		_trips++;
+	}
+};
+
+struct TargetHealth
+{
+	RttEstimator rtt;
+	CircuitBreaker breaker;
+};
+
+} // namespace Node_Utility
+
+#endif // MODBUS_HEALTH_HPP
@@ -0,0 +1,84 @@
+#ifndef MODBUS_POLL_PROFILE_HPP
+#define MODBUS_POLL_PROFILE_HPP
+
+#include <cstdint>
+#include "StateDefines.h"
+#include "TestData.h"
+#include "ModbusScheduler.hpp"
+
+namespace Node_Utility
+{
+// How hard the poller works in a given phase. cycle_ms is the gap between polling cycles
+// (0 pauses polling), spacing_ms the gap between requests inside one cycle.
+struct PollProfile
+{
+	const char* name;
+	uint32_t cycle_ms;
+	uint32_t spacing_ms;
+	RequestPriority meterPriority;
+};
+
+namespace PollProfiles
+{
+static constexpr PollProfile PAUSED = {"paused", 0, 0, RequestPriority::DASHBOARD};
+static constexpr PollProfile IDLE = {"idle", 5000, 500, RequestPriority::DASHBOARD};
+static constexpr PollProfile STANDBY = {"standby", 2000, 250, RequestPriority::DASHBOARD};
+static constexpr PollProfile TEST = {"test", 500, 50, RequestPriority::TEST_CRITICAL};
+
+// Per test type, used while a test is starting, running or being checked
+static constexpr PollProfile SWITCH_TEST = {"switch", 250, 0, RequestPriority::TEST_CRITICAL};
+static constexpr PollProfile BACKUP_TEST = {"backup", 500, 20, RequestPriority::TEST_CRITICAL};
+// No spacing so the input and output reads of a cycle land back to back
+static constexpr PollProfile EFFICIENCY_TEST = {"efficiency", 1000, 0,
+												RequestPriority::TEST_CRITICAL};
+static constexpr PollProfile INPUT_VOLTAGE_TEST = {"inputVoltage", 500, 50,
+												   RequestPriority::TEST_CRITICAL};
+
+inline const PollProfile& forTest(TestType test)
+{
+	switch(test)
+	{
+		case TestType::SwitchTest:
+			return SWITCH_TEST;
+		case TestType::BackupTest:
+			return BACKUP_TEST;
+		case TestType::EfficiencyTest:
+			return EFFICIENCY_TEST;
+		case TestType::InputVoltageTest:
+			return INPUT_VOLTAGE_TEST;
+		default:
+			return TEST;
+	}
+}
+
+inline const PollProfile& select(Node_Core::State state, bool testActive, TestType test)
+{
+	using Node_Core::State;
+	switch(state)
+	{
+		case State::TEST_START:
+		case State::TEST_RUNNING:
+		case State::CURRENT_TEST_CHECK:
+			return testActive ? forTest(test) : TEST;
+
+		case State::DEVICE_SETUP:
+		case State::SYSTEM_TUNING:
+			return PAUSED;
+
+		case State::DEVICE_READY:
+		case State::READY_TO_PROCEED:
+		case State::CURRENT_TEST_OK:
+		case State::READY_NEXT_TEST:
+		case State::MANUAL_NEXT_TEST:
+		case State::RETEST:
+			return STANDBY;
+
+		default:
+			return IDLE;
+	}
+}
+} // namespace PollProfiles
+
+} // namespace Node_Utility
+
+#endif // MODBUS_POLL_PROFILE_HPP
@@ -0,0 +1,239 @@
+#ifndef MODBUS_READ_CACHE_HPP
+#define MODBUS_READ_CACHE_HPP
+
+#include <ModbusMessage.h>
+#include <Arduino.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
+#include <array>
+#include <cstdint>
+
+namespace Node_Utility
+{
+// Identifies one read on the bus; two requesters with equal keys want the same bytes
+struct ReadKey
+{
+	uint32_t ip = 0; // 0 for RTU
+	uint8_t slave = 0;
+	uint8_t function = 0;
+	uint16_t start = 0;
+	uint16_t length = 0;
+
+	bool operator==(const ReadKey& other) const
+	{
+		return ip == other.ip && slave == other.slave && function == other.function &&
+			   start == other.start && length == other.length;
+	}
+};
+
+// Last reply per read key plus the read currently on the bus for it. A requester either gets
+// a reply young enough for it, joins the outstanding read, or is told to issue its own. Age
+// counts from when a read was requested, so "younger than ttl" also means "asked for after
+// now - ttl", which is what the coil watchdog needs after a write.
+class ModbusReadCache
+{
+  public:
+	static constexpr size_t MAX_ENTRIES = 8;
+	static constexpr size_t MAX_JOINERS = 4;
+	static constexpr uint32_t IN_FLIGHT_EXPIRY_MS = 10000; // eModbus lost the callback
+
+	enum class Result : uint8_t
+	{
+		HIT, // nothing to send; reply is filled unless the requester fetched it itself
+		JOINED, // delivered with the outstanding read
+		MISS // caller sends the read; it is now the outstanding one when a slot was free
+	};
+
+	struct Joiners
+	{
+		std::array<uint32_t, MAX_JOINERS> tokens;
+		uint8_t count = 0;
+	};
+
+	struct Stats
+	{
+		uint32_t hits = 0;
+		uint32_t joins = 0;
+		uint32_t misses = 0;
+		uint32_t evictions = 0;
+		uint32_t expired = 0; // Outstanding reads given up on
+	};
+
+	ModbusReadCache()
+	{
+		cacheMutex = xSemaphoreCreateMutex();
+		configASSERT(cacheMutex);
+	}
+	ModbusReadCache(const ModbusReadCache&) = delete;
+	ModbusReadCache& operator=(const ModbusReadCache&) = delete;
+
+	Result lookup(const ReadKey& key, uint32_t ttl_ms, uint32_t token, ModbusMessage& reply)
+	{
+		Result result = Result::MISS;
+		uint32_t now = millis();
+
+		xSemaphoreTake(cacheMutex, portMAX_DELAY);
+		Entry* entry = find(key);
+		if(entry != nullptr && entry->inFlight && now - entry->requested_ms > IN_FLIGHT_EXPIRY_MS)
+		{
+			entry->inFlight = false;
+			entry->joiners.count = 0;
+			_stats.expired++;
+		}
+
+		if(entry != nullptr && entry->valid && now - entry->fetched_ms <= ttl_ms)
+		{
+			if(entry->fetchedBy != token)
+				reply = entry->reply;
+			result = Result::HIT;
+			_stats.hits++;
+		}
+		else if(entry != nullptr && entry->inFlight &&
+				(entry->token == token || now - entry->requested_ms <= ttl_ms) &&
+				join(*entry, token))
+		{
+			result = Result::JOINED;
+			_stats.joins++;
+		}
+		else
+		{
+			if(entry == nullptr)
+				entry = claim(key);
+			if(entry != nullptr && !entry->inFlight)
+			{
+				entry->inFlight = true;
+				entry->token = token;
+				entry->requested_ms = now;
+				entry->joiners.count = 0;
+			}
+			_stats.misses++;
+		}
+		xSemaphoreGive(cacheMutex);
+		return result;
+	}
+
+	// Reply for an outstanding read; hands back whoever joined it
+	void store(uint32_t token, const ModbusMessage& reply, Joiners& joiners)
+	{
+		joiners.count = 0;
+		xSemaphoreTake(cacheMutex, portMAX_DELAY);
+		Entry* entry = findInFlight(token);
+		if(entry != nullptr)
+		{
+			entry->reply = reply; // Reuses the entry's buffer after the first fill
+			entry->fetched_ms = entry->requested_ms;
+			entry->fetchedBy = token;
+			entry->valid = true;
+			entry->inFlight = false;
+			joiners = entry->joiners;
+		}
+		xSemaphoreGive(cacheMutex);
+	}
+
+	// The outstanding read failed or never went out; its joiners share the outcome
+	void fail(uint32_t token, Joiners& joiners)
+	{
+		joiners.count = 0;
+		xSemaphoreTake(cacheMutex, portMAX_DELAY);
+		Entry* entry = findInFlight(token);
+		if(entry != nullptr)
+		{
+			entry->inFlight = false;
+			joiners = entry->joiners;
+		}
+		xSemaphoreGive(cacheMutex);
+	}
+
+	const Stats& stats() const
+	{
+		return _stats;
+	}
+
+  private:
+	struct Entry
+	{
+		ReadKey key;
+		ModbusMessage reply;
+		uint32_t fetched_ms = 0; // Request time of the read that produced reply
+		uint32_t requested_ms = 0; // Request time of the outstanding read
+		uint32_t fetchedBy = 0; // Token whose handler already processed reply
+		uint32_t token = 0; // Owner of the outstanding read
+		Joiners joiners;
+		bool valid = false;
+		bool inFlight = false;
+		bool used = false;
+	};
+
+	std::array<Entry, MAX_ENTRIES> _entries;
+	Stats _stats;
+	SemaphoreHandle_t cacheMutex = NULL;
+
+	// Callers hold cacheMutex
+	Entry* find(const ReadKey& key)
+	{
+		for(auto& entry: _entries)
+		{
+			if(entry.used && entry.key == key)
+				return &entry;
+		}
+		return nullptr;
+	}
+
+	Entry* findInFlight(uint32_t token)
+	{
+		for(auto& entry: _entries)
+		{
+			if(entry.used && entry.inFlight && entry.token == token)
+				return &entry;
+		}
+		return nullptr;
+	}
+
+	// The owner asking again is already covered by its own outstanding read
+	bool join(Entry& entry, uint32_t token)
+	{
+		if(entry.token == token)
+			return true;
+		for(uint8_t i = 0; i < entry.joiners.count; ++i)
+		{
+			if(entry.joiners.tokens[i] == token)
+				return true;
+		}
+		if(entry.joiners.count == MAX_JOINERS)
+			return false;
+		entry.joiners.tokens[entry.joiners.count++] = token;
+		return true;
+	}
+
+	// Free slot, else the idle entry with the oldest reply; nullptr if all are on the bus
+	Entry* claim(const ReadKey& key)
+	{
+		Entry* victim = nullptr;
+		for(auto& entry: _entries)
+		{
+			if(!entry.used)
+			{
+				victim = &entry;
+				break;
+			}
+			if(!entry.inFlight &&
+			   (victim == nullptr ||
+				static_cast<int32_t>(entry.fetched_ms - victim->fetched_ms) < 0))
+				victim = &entry;
+		}
+		if(victim == nullptr)
+			return nullptr;
+
+		if(victim->used)
+			_stats.evictions++;
+		victim->key = key;
+		victim->valid = false;
+		victim->inFlight = false;
+		victim->used = true;
+		return victim;
+	}
+};
+
+} // namespace Node_Utility
+
+#endif // MODBUS_READ_CACHE_HPP
@@ -0,0 +1,25 @@
+#ifndef MODBUS_RTU_TIMING_HPP
+#define MODBUS_RTU_TIMING_HPP
+
+#include <cstdint>
+
+namespace Node_Utility
+{
+// Silence that ends an RTU frame: 3.5 character times, rounded up, and fixed at 1750 us above
+// 19200 baud (Modbus over serial line spec, 2.5.1.1). Parity is 0 for none, 1 odd, 2 even; a
+// baud rate of 0 gives 0.
+inline uint32_t rtuFrameGapUs(uint32_t baudrate, uint8_t databits, uint8_t parity,
+							  uint8_t stopbits)
+{
+	if(baudrate == 0)
+		return 0;
+	if(baudrate > 19200)
+		return 1750;
+
+	uint32_t bitsPerChar = 1 + databits + (parity != 0 ? 1 : 0) + stopbits;
+	return (bitsPerChar * 3500000UL + baudrate - 1) / baudrate;
+}
+
+} // namespace Node_Utility
+
+#endif // MODBUS_RTU_TIMING_HPP
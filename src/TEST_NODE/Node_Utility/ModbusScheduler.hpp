@@ -0,0 +1,237 @@
+#ifndef MODBUS_SCHEDULER_HPP
+#define MODBUS_SCHEDULER_HPP
+
+#include <ModbusMessage.h>
+#include <Arduino.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
+#include <array>
+#include <cstdint>
+#include "ModbusStats.hpp"
+
+namespace Node_Utility
+{
+enum class RequestPriority : uint8_t
+{
+	CONTROL, // Coil writes and their readbacks
+	TEST_CRITICAL, // Meter reads a running test depends on
+	DASHBOARD // Background polls for the web view
+};
+static constexpr size_t PRIORITY_CLASSES = 3;
+
+// Holds requests in one bounded queue per priority class and releases them highest class
+// first. Reads are only released while fewer than MAX_IN_FLIGHT are outstanding, so the
+// eModbus queues stay short and a control write never waits behind more than that many.
+template<typename Target>
+class ModbusScheduler
+{
+  public:
+	static constexpr size_t QUEUE_DEPTH = 8;
+	static constexpr size_t MAX_IN_FLIGHT = 2;
+	static constexpr size_t MAX_TRACKED = 16;
+	static constexpr uint32_t STALE_IN_FLIGHT_US = 30000000;
+
+	struct Entry
+	{
+		Target target;
+		ModbusMessage message;
+		RequestPriority priority = RequestPriority::DASHBOARD;
+		uint32_t enqueued_us = 0;
+	};
+
+	struct ClassStats
+	{
+		uint32_t enqueued = 0;
+		uint32_t coalesced = 0; // Reads merged into an already queued request for the token
+		uint32_t dropped = 0; // Refused because the class queue was full
+		uint32_t dispatched = 0;
+		uint32_t completed = 0;
+		RttHistogram wait; // Enqueue to hand-off to eModbus
+		RttHistogram latency; // Enqueue to reply or error
+	};
+
+	ModbusScheduler()
+	{
+		schedulerMutex = xSemaphoreCreateMutex();
+		configASSERT(schedulerMutex);
+	}
+	ModbusScheduler(const ModbusScheduler&) = delete;
+	ModbusScheduler& operator=(const ModbusScheduler&) = delete;
+
+	bool enqueue(RequestPriority priority, const Target& target, const ModbusMessage& message)
+	{
+		size_t cls = static_cast<size_t>(priority);
+		ClassQueue& queue = _queues[cls];
+		bool accepted = true;
+
+		xSemaphoreTake(schedulerMutex, portMAX_DELAY);
+		// A poll that is still waiting only needs its newest request; writes must all go out
+		Entry* queued = priority == RequestPriority::CONTROL ? nullptr : find(queue, target.token);
+		if(queued != nullptr)
+		{
+			queued->target = target;
+			queued->message = message;
+			_stats[cls].coalesced++;
+		}
+		else if(queue.count == QUEUE_DEPTH)
+		{
+			_stats[cls].dropped++;
+			accepted = false;
+		}
+		else
+		{
+			Entry& entry = queue.entries[(queue.head + queue.count) % QUEUE_DEPTH];
+			entry.target = target;
+			entry.message = message;
+			entry.priority = priority;
+			entry.enqueued_us = micros();
+			queue.count++;
+			_stats[cls].enqueued++;
+		}
+		xSemaphoreGive(schedulerMutex);
+		return accepted;
+	}
+
+	// Pops the next request allowed to go out and starts tracking it as in flight
+	bool next(Entry& out)
+	{
+		bool found = false;
+
+		xSemaphoreTake(schedulerMutex, portMAX_DELAY);
+		uint32_t now = micros();
+		expireStale(now);
+
+		for(size_t cls = 0; cls < PRIORITY_CLASSES && !found; ++cls)
+		{
+			ClassQueue& queue = _queues[cls];
+			if(queue.count == 0)
+				continue;
+			if(cls != static_cast<size_t>(RequestPriority::CONTROL) &&
+			   _readsInFlight >= MAX_IN_FLIGHT)
+				break; // Lower classes are held back too
+
+			out = queue.entries[queue.head];
+			queue.head = (queue.head + 1) % QUEUE_DEPTH;
+			queue.count--;
+
+			_stats[cls].dispatched++;
+			_stats[cls].wait.record(now - out.enqueued_us);
+			track(out, now);
+			found = true;
+		}
+		xSemaphoreGive(schedulerMutex);
+		return found;
+	}
+
+	// Called with the token of every reply or error, including failed hand-offs
+	void complete(uint32_t token)
+	{
+		xSemaphoreTake(schedulerMutex, portMAX_DELAY);
+		for(auto& slot: _inFlight)
+		{
+			if(slot.active && slot.token == token)
+			{
+				size_t cls = static_cast<size_t>(slot.priority);
+				_stats[cls].completed++;
+				_stats[cls].latency.record(micros() - slot.enqueued_us);
+				release(slot);
+				break;
+			}
+		}
+		xSemaphoreGive(schedulerMutex);
+	}
+
+	size_t queued(RequestPriority priority) const
+	{
+		return _queues[static_cast<size_t>(priority)].count;
+	}
+	size_t queuedTotal() const
+	{
+		size_t total = 0;
+		for(const auto& queue: _queues)
+			total += queue.count;
+		return total;
+	}
+	size_t readsInFlight() const
+	{
+		return _readsInFlight;
+	}
+	const ClassStats& stats(RequestPriority priority) const
+	{
+		return _stats[static_cast<size_t>(priority)];
+	}
+
+  private:
+	struct ClassQueue
+	{
+		std::array<Entry, QUEUE_DEPTH> entries;
+		size_t head = 0;
+		size_t count = 0;
+	};
+	struct InFlight
+	{
+		uint32_t token = 0;
+		uint32_t enqueued_us = 0;
+		uint32_t dispatched_us = 0;
+		RequestPriority priority = RequestPriority::DASHBOARD;
+		bool active = false;
+	};
+
+	std::array<ClassQueue, PRIORITY_CLASSES> _queues;
+	std::array<ClassStats, PRIORITY_CLASSES> _stats;
+	std::array<InFlight, MAX_TRACKED> _inFlight;
+	size_t _readsInFlight = 0;
+	SemaphoreHandle_t schedulerMutex = NULL;
+
+	// Callers hold schedulerMutex
+	Entry* find(ClassQueue& queue, uint32_t token)
+	{
+		for(size_t i = 0; i < queue.count; ++i)
+		{
+			Entry& entry = queue.entries[(queue.head + i) % QUEUE_DEPTH];
+			if(entry.target.token == token)
+				return &entry;
+		}
+		return nullptr;
+	}
+
+	void track(const Entry& entry, uint32_t now)
+	{
+		for(auto& slot: _inFlight)
+		{
+			if(!slot.active)
+			{
+				slot.token = entry.target.token;
+				slot.enqueued_us = entry.enqueued_us;
+				slot.dispatched_us = now;
+				slot.priority = entry.priority;
+				slot.active = true;
+				if(entry.priority != RequestPriority::CONTROL)
+					_readsInFlight++;
+				return;
+			}
+		}
+		// Table full: the request still goes out, it just is not counted
+	}
+
+	void release(InFlight& slot)
+	{
+		if(slot.priority != RequestPriority::CONTROL && _readsInFlight > 0)
+			_readsInFlight--;
+		slot.active = false;
+	}
+
+	// eModbus always answers with data or an error, so this only catches lost callbacks
+	void expireStale(uint32_t now)
+	{
+		for(auto& slot: _inFlight)
+		{
+			if(slot.active && now - slot.dispatched_us > STALE_IN_FLIGHT_US)
+				release(slot);
+		}
+	}
+};
+
+} // namespace Node_Utility
+
+#endif // MODBUS_SCHEDULER_HPP
@@ -0,0 +1,214 @@
+#ifndef MODBUS_STATS_HPP
+#define MODBUS_STATS_HPP
+
+#include <ModbusTypeDefs.h>
+#include <IPAddress.h>
+#include <Arduino.h>
+#include <array>
+#include <cstdint>
+
+namespace Node_Utility
+{
+// Log2-bucketed round-trip times. Bucket 0 holds replies under 1 ms, bucket i holds
+// [2^(i-1), 2^i) ms, and the last bucket everything from 2^(BUCKETS-2) ms up.
+class RttHistogram
+{
+  public:
+	static constexpr size_t BUCKETS = 16;
+
+	void record(uint32_t rtt_us)
+	{
+		uint32_t ms = rtt_us / 1000;
+		size_t bucket = ms == 0 ? 0 : 32 - __builtin_clz(ms);
+		if(bucket >= BUCKETS)
+			bucket = BUCKETS - 1;
+		_buckets[bucket]++;
+		_count++;
+		if(rtt_us > _max_us)
+			_max_us = rtt_us;
+	}
+
+	// Upper edge of the bucket holding the given fraction of samples, in ms
+	uint32_t percentileMs(float fraction) const
+	{
+		if(_count == 0)
+			return 0;
+		uint32_t rank = static_cast<uint32_t>(fraction * _count);
+		uint32_t seen = 0;
+		for(size_t i = 0; i < BUCKETS; ++i)
+		{
+			seen += _buckets[i];
+			if(seen > rank)
+				return bucketUpperMs(i);
+		}
+		return bucketUpperMs(BUCKETS - 1);
+	}
+
+	static uint32_t bucketUpperMs(size_t bucket)
+	{
+		return 1UL << bucket;
+	}
+
+	uint32_t count() const
+	{
+		return _count;
+	}
+	uint32_t maxUs() const
+	{
+		return _max_us;
+	}
+	uint32_t bucket(size_t index) const
+	{
+		return _buckets[index];
+	}
+
+  private:
+	std::array<uint32_t, BUCKETS> _buckets{};
+	uint32_t _count = 0;
+	uint32_t _max_us = 0;
+};
+
+struct ModbusTargetStats
+{
+	// Identity, copied from the target when the slot is assigned
+	IPAddress ip;
+	uint8_t slave_id = 0;
+	uint8_t function_code = 0;
+	uint16_t start_address = 0;
+	uint8_t type = 0;
+
+	uint32_t requests = 0; // Accepted by a client queue
+	uint32_t rejected = 0; // Refused at addRequest
+	uint32_t responses = 0;
+	uint32_t timeouts = 0;
+	uint32_t exceptions = 0; // Modbus exception replies from the server or gateway
+	uint32_t errors = 0; // Everything else eModbus reports (connection, CRC, framing)
+	uint8_t lastError = 0;
+	uint32_t issued_us = 0;
+	uint32_t lastRtt_us = 0;
+	uint32_t lastSuccess_ms = 0; // 0 until the first good reply
+	RttHistogram rtt;
+};
+
+// Fixed table of per-target counters. Slots are assigned when targets are created and never
+// move, so the eModbus callbacks update them by index without locking; readers may see a
+// sample half-applied, which is acceptable for monitoring.
+class ModbusStats
+{
+  public:
+	static constexpr size_t MAX_TARGETS = 24;
+	static constexpr uint8_t NO_SLOT = 0xFF;
+
+	uint8_t assign(IPAddress ip, uint8_t slaveId, uint8_t functionCode, uint16_t startAddress,
+				   uint8_t type)
+	{
+		// A target removed and added again keeps its history
+		for(size_t i = 0; i < _count; ++i)
+		{
+			const ModbusTargetStats& t = _targets[i];
+			if(t.ip == ip && t.slave_id == slaveId && t.function_code == functionCode &&
+			   t.start_address == startAddress && t.type == type)
+				return static_cast<uint8_t>(i);
+		}
+		if(_count >= MAX_TARGETS)
+			return NO_SLOT;
+
+		ModbusTargetStats& slot = _targets[_count];
+		slot = ModbusTargetStats();
+		slot.ip = ip;
+		slot.slave_id = slaveId;
+		slot.function_code = functionCode;
+		slot.start_address = startAddress;
+		slot.type = type;
+		return static_cast<uint8_t>(_count++);
+	}
+
+	void onIssued(uint8_t slot, Modbus::Error result)
+	{
+		if(slot >= _count)
+			return;
+		if(result == Modbus::SUCCESS)
+		{
+			_targets[slot].requests++;
+			_targets[slot].issued_us = micros();
+		}
+		else
+		{
+			_targets[slot].rejected++;
+			_targets[slot].lastError = static_cast<uint8_t>(result);
+		}
+	}
+
+	void onResponse(uint8_t slot)
+	{
+		if(slot >= _count)
+			return;
+		ModbusTargetStats& stats = _targets[slot];
+		stats.lastRtt_us = micros() - stats.issued_us;
+		stats.rtt.record(stats.lastRtt_us);
+		stats.responses++;
+		stats.lastSuccess_ms = millis();
+	}
+
+	void onError(uint8_t slot, Modbus::Error error)
+	{
+		if(slot >= _count)
+			return;
+		ModbusTargetStats& stats = _targets[slot];
+		stats.lastError = static_cast<uint8_t>(error);
+		if(error == Modbus::TIMEOUT)
+			stats.timeouts++;
+		else if(isException(error))
+			stats.exceptions++;
+		else
+			stats.errors++;
+	}
+
+	void sampleQueueDepth(uint32_t depth)
+	{
+		_queueDepth = depth;
+		if(depth > _maxQueueDepth)
+			_maxQueueDepth = depth;
+	}
+
+	// Exception codes 0x01..0x0B are what a server sends back; eModbus' own errors sit above
+	static bool isException(Modbus::Error error)
+	{
+		return error >= Modbus::ILLEGAL_FUNCTION && error <= Modbus::GATEWAY_TARGET_NO_RESP;
+	}
+
+	// Milliseconds since the last good reply, -1 if there has never been one
+	static int32_t successAgeMs(const ModbusTargetStats& stats)
+	{
+		if(stats.lastSuccess_ms == 0)
+			return -1;
+		return static_cast<int32_t>(millis() - stats.lastSuccess_ms);
+	}
+
+	size_t size() const
+	{
+		return _count;
+	}
+	const ModbusTargetStats& at(size_t slot) const
+	{
+		return _targets[slot];
+	}
+	uint32_t queueDepth() const
+	{
+		return _queueDepth;
+	}
+	uint32_t maxQueueDepth() const
+	{
+		return _maxQueueDepth;
+	}
+
+  private:
+	std::array<ModbusTargetStats, MAX_TARGETS> _targets;
+	size_t _count = 0;
+	uint32_t _queueDepth = 0;
+	uint32_t _maxQueueDepth = 0;
+};
+
+} // namespace Node_Utility
+
+#endif // MODBUS_STATS_HPP
@@ -0,0 +1,257 @@
+#ifndef MODBUS_STATUS_SERVER_HPP
+#define MODBUS_STATUS_SERVER_HPP
+
+#include <ModbusServerWiFi.h>
+#include <Arduino.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include "HPTSettings.h"
+#include "PZEM_Measure.hpp"
+#include "StateDefines.h"
+#include "TestData.h"
+#include "RegisterImage.hpp"
+
+namespace Node_Utility
+{
+// Read-only Modbus TCP view of the node for a line PLC. FC 03 (holding) and FC 04 (input)
+// serve the same register image; writes are refused with ILLEGAL_FUNCTION.
+//
+//   0  map version            10-29  switch results, 5 x {valid, load %, time ms hi, lo}
+//   1  heartbeat (publishes)  30-49  backup results, 5 x {valid, load %, time ms hi, lo}
+//   2  Node_Core::State       50-59  input  V, A, W, pf, Hz as float32, high word first
+//   3  active TestType bits   60-69  output V, A, W, pf, Hz as float32, high word first
+//   4  test running (0/1)     70-74  efficiency mean, ci95 (float32), samples
+//
+// Producers update a staging copy under statusMutex and publish it to the RegisterImage, so
+// PLC reads never wait on the test path and the test path never waits on a PLC.
+class ModbusStatusServer
+{
+  public:
+	static constexpr uint16_t MAP_VERSION = 1;
+	static constexpr uint16_t PORT = 502;
+	static constexpr uint8_t SERVER_ID = 1;
+	static constexpr uint8_t MAX_CLIENTS = 2;
+	static constexpr uint32_t CLIENT_TIMEOUT_MS = 20000;
+	static constexpr uint16_t MAX_READ_WORDS = 125; // Modbus limit for FC 03/04
+
+	static constexpr size_t REG_VERSION = 0;
+	static constexpr size_t REG_HEARTBEAT = 1;
+	static constexpr size_t REG_STATE = 2;
+	static constexpr size_t REG_TEST = 3;
+	static constexpr size_t REG_TEST_RUNNING = 4;
+	static constexpr size_t REG_SWITCH_RESULTS = 10;
+	static constexpr size_t REG_BACKUP_RESULTS = 30;
+	static constexpr size_t REG_INPUT_POWER = 50;
+	static constexpr size_t REG_OUTPUT_POWER = 60;
+	static constexpr size_t REG_EFFICIENCY = 70;
+	static constexpr size_t RESULT_WORDS = 4;
+	static constexpr size_t RESULT_SLOTS = 5;
+	static constexpr size_t IMAGE_WORDS = 80;
+
+	using Image = RegisterImage<IMAGE_WORDS>;
+
+	static ModbusStatusServer& getInstance()
+	{
+		static ModbusStatusServer instance;
+		return instance;
+	}
+
+	// Call once the network is up
+	bool begin(uint16_t port = PORT)
+	{
+		if(_started)
+			return true;
+
+		MBSworker worker = [this](ModbusMessage request) { return this->serveRead(request); };
+		_server.registerWorker(SERVER_ID, READ_HOLD_REGISTER, worker);
+		_server.registerWorker(SERVER_ID, READ_INPUT_REGISTER, worker);
+
+		_started = _server.start(port, MAX_CLIENTS, CLIENT_TIMEOUT_MS, modbusServer_CORE);
+		Serial.printf("Modbus status server %s on port %u\n", _started ? "started" : "failed",
+					  port);
+		return _started;
+	}
+
+	void publishState(Node_Core::State state)
+	{
+		xSemaphoreTake(statusMutex, portMAX_DELAY);
+		_staging[REG_STATE] = static_cast<uint16_t>(state);
+		publishLocked();
+		xSemaphoreGive(statusMutex);
+	}
+
+	void publishTest(TestType test, bool running)
+	{
+		xSemaphoreTake(statusMutex, portMAX_DELAY);
+		_staging[REG_TEST] = running ? static_cast<uint16_t>(test) : 0;
+		_staging[REG_TEST_RUNNING] = running ? 1 : 0;
+		publishLocked();
+		xSemaphoreGive(statusMutex);
+	}
+
+	void publishResults(const SwitchTestData& data)
+	{
+		xSemaphoreTake(statusMutex, portMAX_DELAY);
+		for(size_t i = 0; i < RESULT_SLOTS; ++i)
+		{
+			const SwitchTestData::SingleTest& test = data.switchTest[i];
+			putResult(REG_SWITCH_RESULTS + i * RESULT_WORDS, test, test.switchtime);
+		}
+		publishLocked();
+		xSemaphoreGive(statusMutex);
+	}
+
+	void publishResults(const BackupTestData& data)
+	{
+		xSemaphoreTake(statusMutex, portMAX_DELAY);
+		for(size_t i = 0; i < RESULT_SLOTS; ++i)
+		{
+			const BackupTestData::SingleTest& test = data.backupTest[i];
+			putResult(REG_BACKUP_RESULTS + i * RESULT_WORDS, test, test.backuptime);
+		}
+		publishLocked();
+		xSemaphoreGive(statusMutex);
+	}
+
+	void publishPower(const Node_Core::OutBox& input, const Node_Core::OutBox& output)
+	{
+		xSemaphoreTake(statusMutex, portMAX_DELAY);
+		putPower(REG_INPUT_POWER, input);
+		putPower(REG_OUTPUT_POWER, output);
+		publishLocked();
+		xSemaphoreGive(statusMutex);
+	}
+
+	void publishEfficiency(float mean, float ci95, uint32_t samples)
+	{
+		xSemaphoreTake(statusMutex, portMAX_DELAY);
+		putFloat(REG_EFFICIENCY, mean);
+		putFloat(REG_EFFICIENCY + 2, ci95);
+		_staging[REG_EFFICIENCY + 4] = samples > 0xFFFF ? 0xFFFF : static_cast<uint16_t>(samples);
+		publishLocked();
+		xSemaphoreGive(statusMutex);
+	}
+
+	const Image& image() const
+	{
+		return _image;
+	}
+	bool isRunning()
+	{
+		return _started && _server.isRunning();
+	}
+	uint16_t activeClients()
+	{
+		return _server.activeClients();
+	}
+	uint32_t reads() const
+	{
+		return _reads.load();
+	}
+	uint32_t refused() const
+	{
+		return _refused.load();
+	}
+
+  private:
+	ModbusServerWiFi _server;
+	Image _image;
+	std::array<uint16_t, IMAGE_WORDS> _staging{};
+	SemaphoreHandle_t statusMutex = NULL;
+	bool _started = false;
+	std::atomic<uint32_t> _reads{0};
+	std::atomic<uint32_t> _refused{0};
+
+	ModbusStatusServer()
+	{
+		statusMutex = xSemaphoreCreateMutex();
+		configASSERT(statusMutex);
+		_staging[REG_VERSION] = MAP_VERSION;
+		_image.publish(_staging);
+	}
+	ModbusStatusServer(const ModbusStatusServer&) = delete;
+	ModbusStatusServer& operator=(const ModbusStatusServer&) = delete;
+
+	// Runs in the eModbus server task and only touches the published image
+	ModbusMessage serveRead(const ModbusMessage& request)
+	{
+		ModbusMessage response;
+		uint16_t address = 0;
+		uint16_t words = 0;
+		request.get(2, address);
+		request.get(4, words);
+
+		if(words == 0 || words > MAX_READ_WORDS)
+		{
+			_refused++;
+			response.setError(request.getServerID(), request.getFunctionCode(),
+							  ILLEGAL_DATA_VALUE);
+			return response;
+		}
+
+		uint16_t values[MAX_READ_WORDS];
+		if(address >= IMAGE_WORDS || words > IMAGE_WORDS - address)
+		{
+			_refused++;
+			response.setError(request.getServerID(), request.getFunctionCode(),
+							  ILLEGAL_DATA_ADDRESS);
+			return response;
+		}
+		if(!_image.read(address, words, values))
+		{
+			_refused++;
+			response.setError(request.getServerID(), request.getFunctionCode(),
+							  SERVER_DEVICE_BUSY);
+			return response;
+		}
+
+		_reads++;
+		response.add(request.getServerID(), request.getFunctionCode(),
+					 static_cast<uint8_t>(words * 2));
+		for(uint16_t i = 0; i < words; ++i)
+		{
+			response.add(values[i]);
+		}
+		return response;
+	}
+
+	// Callers hold statusMutex
+	void publishLocked()
+	{
+		_staging[REG_HEARTBEAT]++;
+		_image.publish(_staging);
+	}
+
+	void putResult(size_t reg, const TestData& test, unsigned long time_ms)
+	{
+		_staging[reg] = test.valid_data ? 1 : 0;
+		_staging[reg + 1] = static_cast<uint16_t>(test.load_percentage);
+		_staging[reg + 2] = static_cast<uint16_t>(static_cast<uint32_t>(time_ms) >> 16);
+		_staging[reg + 3] = static_cast<uint16_t>(time_ms & 0xFFFF);
+	}
+
+	void putPower(size_t reg, const Node_Core::OutBox& box)
+	{
+		putFloat(reg, box.voltage);
+		putFloat(reg + 2, box.current);
+		putFloat(reg + 4, box.power);
+		putFloat(reg + 6, box.powerfactor);
+		putFloat(reg + 8, box.frequency);
+	}
+
+	void putFloat(size_t reg, float value)
+	{
+		uint32_t bits;
+		memcpy(&bits, &value, sizeof(bits));
+		_staging[reg] = static_cast<uint16_t>(bits >> 16);
+		_staging[reg + 1] = static_cast<uint16_t>(bits & 0xFFFF);
+	}
+};
+
+} // namespace Node_Utility
+
+#endif // MODBUS_STATUS_SERVER_HPP
@@ -133,6 +133,8 @@ const char* ToString::wsPowerDataType(Node_Core::wsPowerDataType type)
 			return "modbus";
 		case Node_Core::SettingType::NETWORK:
 			return "network";
+		case Node_Core::SettingType::CALIBRATION:
+			return "calibration";
 		default:
 			return "NONE";
 	}
@@ -2,22 +2,43 @@
 	#define PZEM_MODBUS_HPP
 
 	#include <ModbusClientTCP.h>
+	#include <ModbusClientRTU.h>
 	#include <IPAddress.h>
 	#include <memory>
 	#include <vector>
+	#include <initializer_list>
 	#include <algorithm>
 	#include <freertos/FreeRTOS.h>
 	#include <freertos/task.h>
 	#include <Arduino.h>
 	#include "HPTSettings.h"
+	#include "HardwareConfig.h"
+	#include "Settings.h"
+	#include "SettingsObserver.h"
 	#include "PZEM_Measure.hpp"
 	#include "NodeUtility.hpp"
+	#include "ModbusClientPool.hpp"
+	#include "MeterRegistry.hpp"
+	#include "ModbusStats.hpp"
+	#include "ModbusHealth.hpp"
+	#include "ModbusScheduler.hpp"
+	#include "ModbusPollProfile.hpp"
+	#include "PowerSampling.hpp"
+	#include "ModbusStatusServer.hpp"
+	#include "ModbusReadCache.hpp"
+	#include "ModbusRtuTiming.hpp"
 	#include "string.h"
 	#include <cstring>
 	#include <cstdint>
 	#include <type_traits>
+	#include <atomic>
 	#include <WiFiClient.h>
 
+	// Per-request tracing (every response and coil confirmation); build with -D MODBUS_DEBUG=1
+	#ifndef MODBUS_DEBUG
+		#define MODBUS_DEBUG 0
+	#endif
+
 namespace Node_Utility
 {
 enum class TargetType
@@ -26,8 +47,14 @@ enum class TargetType
 	OUTPUT_POWER,
 	SWITCH_CONTROL,
 	COIL_READ,
+	POWER_METER, // Any registered meter, routed by meter_id
 	ANY
 };
+enum class ModbusTransport
+{
+	TCP, // ModbusClientTCP over WiFi, addressed by target_ip
+	RTU // ModbusClientRTU on the RS485 port, addressed by slave_id only
+};
 enum class CoilType
 {
 	UPS_IN = 0,
@@ -41,7 +68,7 @@ enum class CoilState
 	OFF = 0,
 	ON = 1
 };
-class ModbusManager
+class ModbusManager : public Node_Core::SettingsObserver
 {
   public:
 	struct Target
@@ -55,6 +82,10 @@ class ModbusManager
 		uint16_t length = 1;
 		uint16_t value = 1;
 		uint16_t last_written_value = 0xFFFF;
+		ModbusTransport transport = ModbusTransport::TCP;
+		uint8_t meter_id = MeterRegistry::NO_METER; // Registry slot fed by power targets
+		uint8_t stats_slot = ModbusStats::NO_SLOT;
+		RequestPriority priority = RequestPriority::DASHBOARD;
 	};
 	struct TesterCoil
 	{
@@ -62,39 +93,143 @@ class ModbusManager
 		uint16_t CoilAddress;
 		bool CoilValue;
 	};
-	struct WatchdogRequest
+	enum class ConfirmEventType
+	{
+		ISSUED, // A coil write was queued; start its deadline
+		OBSERVED, // A write echo or bank readback reported coil values
+		FAILED, // eModbus reported an error for the token
+		CANCELLED // The write never made it into the client queue
+	};
+	struct CoilConfirmEvent
+	{
+		ConfirmEventType type;
+		uint32_t token;
+		uint16_t coilMask; // Coils covered by the write (ISSUED)
+		uint16_t valueMask; // Expected (ISSUED) or observed (OBSERVED) coil values
+		uint32_t at_us;
+		bool readback;
+	};
+	struct CoilConfirmStats
+	{
+		uint32_t confirmed = 0;
+		uint32_t failed = 0;
+		uint32_t readbacks = 0;
+		uint32_t last_us = 0;
+		uint32_t max_us = 0;
+		uint64_t total_us = 0;
+	};
+	struct CoilCommand
 	{
 		CoilType type;
-		CoilState expectedState;
-		uint32_t timeout;
+		CoilState state;
+	};
+	struct PollPlanStats
+	{
+		size_t blocks = 0; // Requests per polling cycle
+		size_t targets = 0; // Polled targets they cover
+		uint32_t framesEncoded = 0; // setMessage calls for polls, coil writes and readbacks
+		uint32_t framesReused = 0; // Submits served from a cached frame
 	};
 	static constexpr uint16_t MAX_COILS = 5;
 	static constexpr uint16_t MAX_RETRIES = 4;
 	static constexpr size_t WATCHDOG_QUEUE_SIZE = 10; // Adjust as need
+	static constexpr uint32_t COIL_CONFIRM_DEADLINE_MS = 200; // Write echo expected by then
+	static constexpr uint32_t COIL_READBACK_DEADLINE_MS = 300; // Single readback after a miss
 	static constexpr uint16_t UPS_IN_COIL_ADDR = 0;
 	static constexpr uint16_t LOAD_BANK_1_COIL_ADDR = 1;
 	static constexpr uint16_t LOAD_BANK_2_COIL_ADDR = 2;
 	static constexpr uint16_t LOAD_BANK_3_COIL_ADDR = 3;
 	static constexpr uint16_t TEST_UPDATE_COIL_ADDR = 4;
+	// Coils are contiguous from UPS_IN, so the whole bank fits one FC 0x0F / 0x01 frame
+	static constexpr uint16_t COIL_BANK_START_ADDR = UPS_IN_COIL_ADDR;
+	static constexpr uint8_t COIL_BANK_BYTES = (MAX_COILS + 7) / 8;
+	static constexpr uint16_t COIL_MASK_UNKNOWN = 0xFFFF;
+	static constexpr uint16_t MODBUS_TCP_PORT = 502;
+	static constexpr uint32_t DISPATCH_IDLE_MS = 100; // Re-check for expired in-flight slots
+	static constexpr uint32_t PAUSED_MAINTAIN_MS = 5000; // Pool upkeep while polling is paused
+	static constexpr size_t MAX_BLOCK_MEMBERS = 8;
+	static constexpr uint16_t MAX_BLOCK_REGISTERS = 125; // FC 03/04 limit
 
   private:
-	WiFiClient theClient;
-	std::unique_ptr<ModbusClientTCP> MBClient;
+	ModbusTcpPool _tcpPool;
+	std::unique_ptr<ModbusClientRTU> RTUClient;
+	SetupModbus _rtuConfig; // Line settings for the RS485 bus, opened by the first RTU target
 	uint32_t _timeout;
 	uint32_t _interval;
 	std::vector<Target> _targets;
 	std::array<TesterCoil, MAX_COILS> _coils;
+	Target _coilBankWrite;
+	Target _coilBankRead;
+	uint16_t _lastCoilBankMask = COIL_MASK_UNKNOWN;
+
+	// Polled reads, encoded once when the target list changes. Register reads to the same
+	// slave whose ranges touch or overlap share one block, and the reply is split back out.
+	struct PollBlock
+	{
+		Target wire; // A lone member goes out as itself; merged blocks get their own token
+		ModbusMessage frame;
+		Modbus::Error frameError = Modbus::SUCCESS;
+		std::array<uint8_t, MAX_BLOCK_MEMBERS> members; // Indices into _targets
+		uint8_t memberCount = 0;
+	};
+	std::vector<PollBlock> _pollPlan;
+	// Guards _targets, _pollPlan, the coil state (_coils, the bank targets and frames,
+	// _lastCoilBankMask) and the per-target health and issue counts, which the caller's task,
+	// the dispatch task, the watchdog and the eModbus callbacks share.
+	// Indices and pointers into them only hold while it is taken. Recursive because responses
+	// served from the read cache re-enter through deliverResponse.
+	SemaphoreHandle_t targetMutex = NULL;
+	std::array<std::array<ModbusMessage, 2>, MAX_COILS> _coilFrames; // [address][off, on]
+	ModbusMessage _coilReadbackFrame;
+	PollPlanStats _planStats;
+	ModbusReadCache _readCache;
+
+	// Outstanding coil writes, owned by the watchdog task; what they touch beyond this table
+	// is taken under targetMutex
+	struct CoilConfirmation
+	{
+		uint32_t token = 0;
+		uint32_t readToken = 0;
+		uint16_t coilMask = 0;
+		uint16_t expectedMask = 0;
+		uint32_t issued_us = 0;
+		uint32_t deadline_us = 0;
+		bool readbackIssued = false;
+		bool active = false;
+	};
+	std::array<CoilConfirmation, WATCHDOG_QUEUE_SIZE> _pendingConfirms;
+	CoilConfirmStats _confirmStats;
 
 	TaskHandle_t pollingTaskHandle = NULL;
 	TaskHandle_t watchDogTaskHandle = NULL;
+	TaskHandle_t dispatchTaskHandle = NULL;
 	QueueHandle_t coilWatchdogQueue = NULL;
 	IPAddress pzemServerIP = IPAddress(192, 168, 0, 160);
 	uint8_t coilserver_id = 0;
 	uint8_t ipd_id = 0;
 	uint8_t opd_id = 0;
-	uint32_t _currentToken;
-	Node_Core::OutBox inputPower = OutBox();
-	Node_Core::OutBox outputPower = OutBox();
+	std::atomic<uint32_t> _currentToken;
+	MeterRegistry _meters;
+	ModbusStats _stats;
+	std::array<TargetHealth, ModbusStats::MAX_TARGETS> _health; // Indexed like _stats
+	ModbusScheduler<Target> _scheduler;
+
+	// Input/output pairing for the efficiency estimate, guarded by samplingMutex
+	PairedSampler _sampler;
+	EfficiencyEstimator _efficiency;
+	AlignedPair _lastPair;
+	SemaphoreHandle_t samplingMutex = NULL;
+	SemaphoreHandle_t meterMutex = NULL; // Guards the registry's readings and coefficients
+
+	// Drive the poll profile; written by the state machine and test sync tasks
+	std::atomic<Node_Core::State> _nodeState{Node_Core::State::DEVICE_ON};
+	std::atomic<TestType> _activeTest{TestType::SwitchTest};
+	std::atomic<bool> _testActive{false};
+	std::atomic<const PollProfile*> _profile{&PollProfiles::IDLE};
+
+	// Notified with eSetBits after every fresh snapshot; repeated bits coalesce in the task
+	std::atomic<TaskHandle_t> _snapshotListener{nullptr};
+	std::atomic<uint32_t> _snapshotBits{0};
 
 	bool allTaskCreated = false;
 	bool updateSingleCoil = true;
@@ -104,24 +239,29 @@ class ModbusManager
 	ModbusManager(uint32_t tm = 4000, uint32_t inter = 2000,
 				  IPAddress serverIP = IPAddress(192, 168, 0, 172), u8_t coilServerId = 1,
 				  uint8_t inputPowerId = 1, uint8_t outputPowerId = 2) :
-		MBClient(std::make_unique<ModbusClientTCP>(theClient)),
 		_timeout(tm), _interval(inter), pzemServerIP(serverIP), coilserver_id(coilServerId),
 		ipd_id(inputPowerId), opd_id(outputPowerId), _currentToken(0)
 	{
+		samplingMutex = xSemaphoreCreateMutex();
+		configASSERT(samplingMutex);
+		meterMutex = xSemaphoreCreateMutex();
+		configASSERT(meterMutex);
+		targetMutex = xSemaphoreCreateRecursiveMutex();
+		configASSERT(targetMutex);
 		init();
 		configASSERT(createAllTask());
 		// Create the queue
-		coilWatchdogQueue = xQueueCreate(WATCHDOG_QUEUE_SIZE, sizeof(WatchdogRequest));
+		coilWatchdogQueue = xQueueCreate(WATCHDOG_QUEUE_SIZE, sizeof(CoilConfirmEvent));
 		configASSERT(coilWatchdogQueue);
-		MBClient->begin(); // Start ModbusTCP background task
 	}
 	void init()
 	{
-		MBClient->setTimeout(_timeout, _interval);
-		MBClient->onDataHandler([this](ModbusMessage response, uint32_t token) {
+		// Pooled TCP clients start lazily on the first request to their endpoint
+		_tcpPool.setTimeout(_timeout, _interval);
+		_tcpPool.onDataHandler([this](ModbusMessage response, uint32_t token) {
 			this->handleData(response, token);
 		});
-		MBClient->onErrorHandler([this](Error error, uint32_t token) {
+		_tcpPool.onErrorHandler([this](Error error, uint32_t token) {
 			this->handleError(error, token);
 		});
 		_coils = {
@@ -168,7 +308,20 @@ class ModbusManager
 					   modbus_CORE // Core ID
 					   ))
 				{
-					allTaskCreated = true;
+					if(xTaskCreatePinnedToCore(
+						   [](void* param) {
+							   static_cast<ModbusManager*>(param)->dispatchTask();
+						   },
+						   "ModbusDispatchTask",
+						   modbusDispatch_Stack, // Stack size
+						   this, // Parameter
+						   modbusDispatch_Priority, // Priority
+						   &dispatchTaskHandle, // Task handle
+						   modbusDispatch_CORE // Core ID
+						   ))
+					{
+						allTaskCreated = true;
+					}
 				}
 			}
 		}
@@ -189,137 +342,382 @@ class ModbusManager
 	{
 		while(true)
 		{
-			if(enablePolling)
+			const PollProfile& profile = selectProfile();
+			if(enablePolling && profile.cycle_ms != 0)
 			{
-				for(const auto& target: _targets)
+				// One block per lock hold, so targets can change between requests
+				for(size_t i = 0;; ++i)
 				{
-					if(target.type == TargetType::INPUT_POWER ||
-					   target.type == TargetType::OUTPUT_POWER ||
-					   target.type == TargetType::COIL_READ)
+					xSemaphoreTakeRecursive(targetMutex, portMAX_DELAY);
+					if(i >= _pollPlan.size())
 					{
-						MBClient->setTarget(target.target_ip, 502, _timeout, _interval);
-
-						Modbus::Error modbusError = MBClient->addRequest(
-							target.token, target.slave_id, target.function_code,
-							target.start_address, target.length);
+						xSemaphoreGiveRecursive(targetMutex);
+						break;
+					}
+					const PollBlock& block = _pollPlan[i];
+					TargetHealth* health = healthOf(block.wire);
+					if(health != nullptr && !health->breaker.allowRequest())
+					{
+						xSemaphoreGiveRecursive(targetMutex);
+						continue; // Open breaker: skip without eating the cadence
+					}
 
-						if(modbusError != Modbus::SUCCESS)
-						{
-							ModbusError e(modbusError);
-							Serial.printf("Error creating request for token %08X: %02X - %s\n",
-										  target.token, (int)e, (const char*)e);
-						}
+					Modbus::Error modbusError = block.frameError;
+					if(modbusError == Modbus::SUCCESS)
+					{
+						Target polled = block.wire;
+						if(isPowerTarget(polled))
+							polled.priority = profile.meterPriority;
+						// Data from the last half cycle, or a read already out, is good enough
+						ModbusReadCache::Result cached;
+						modbusError = submitRead(polled, block.frame, profile.cycle_ms / 2, cached);
+						if(cached != ModbusReadCache::Result::MISS && health != nullptr)
+							health->breaker.cancelProbe();
+					}
 
-						vTaskDelay(pdMS_TO_TICKS(500)); // Delay between requests
+					if(modbusError != Modbus::SUCCESS)
+					{
+						ModbusError e(modbusError);
+						Serial.printf("Error creating request for token %08X: %02X - %s\n",
+									  block.wire.token, (int)e, (const char*)e);
+						if(health != nullptr)
+							health->breaker.cancelProbe();
 					}
+					xSemaphoreGiveRecursive(targetMutex);
+
+					if(profile.spacing_ms != 0)
+						vTaskDelay(pdMS_TO_TICKS(profile.spacing_ms)); // Between requests
 				}
 			}
 
-			vTaskDelay(pdMS_TO_TICKS(1000)); // Delay before the next polling cycle
+			_tcpPool.maintain();
+			_stats.sampleQueueDepth(pendingRequests());
+
+			// A state or test change notifies the task, so a new profile applies at once
+			uint32_t wait_ms = profile.cycle_ms != 0 ? profile.cycle_ms : PAUSED_MAINTAIN_MS;
+			ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(wait_ms));
+		}
+	}
+
+	const PollProfile& selectProfile()
+	{
+		const PollProfile& profile =
+			PollProfiles::select(_nodeState.load(), _testActive.load(), _activeTest.load());
+		const PollProfile* previous = _profile.exchange(&profile);
+		if(previous != &profile)
+		{
+			Serial.printf("Modbus poll profile: %s (cycle %lu ms)\n", profile.name,
+						  static_cast<unsigned long>(profile.cycle_ms));
+		}
+		return profile;
+	}
+
+	void wakePoller()
+	{
+		if(pollingTaskHandle != NULL)
+		{
+			xTaskNotifyGive(pollingTaskHandle);
 		}
 	}
+	// Confirms coil writes from the write echo, falling back to one bank readback when the
+	// deadline passes or the write errors. Blocks only until the nearest deadline.
 	void coilWatchdogTask()
 	{
-		WatchdogRequest request;
+		CoilConfirmEvent event;
 
 		while(true)
 		{
-			// Wait for a new request
-			if(xQueueReceive(coilWatchdogQueue, &request, portMAX_DELAY) == pdTRUE)
+			bool received =
+				xQueueReceive(coilWatchdogQueue, &event, ticksUntilNextDeadline()) == pdTRUE;
+
+			xSemaphoreTakeRecursive(targetMutex, portMAX_DELAY);
+			if(received)
 			{
-				uint16_t retries = 0;
-				bool matchFound = false;
+				handleConfirmEvent(event);
+			}
+			expireConfirmations();
+			xSemaphoreGiveRecursive(targetMutex);
+		}
+	}
 
-				while(retries <= MAX_RETRIES)
-				{
-					// Check the current state of the coil
-					auto coilIt =
-						std::find_if(_coils.begin(), _coils.end(), [&](const TesterCoil& coil) {
-							return coil.type == request.type;
-						});
+	TickType_t ticksUntilNextDeadline() const
+	{
+		uint32_t now = micros();
+		int32_t nearest = INT32_MAX;
 
-					if(coilIt != _coils.end())
-					{
-						// Check if the coil's state matches the expected state
-						bool expectedValue = (request.expectedState == CoilState::ON);
-						if(coilIt->CoilValue == expectedValue)
-						{
-							Serial.printf("Watchdog: Coil %s successfully updated to %s\n",
-										  getCoilTypeName(request.type).c_str(),
-										  expectedValue ? "ON" : "OFF");
-							matchFound = true;
-							break; // Exit retries loop after success
-						}
-					}
+		for(const auto& entry: _pendingConfirms)
+		{
+			if(entry.active)
+			{
+				nearest = std::min(nearest, static_cast<int32_t>(entry.deadline_us - now));
+			}
+		}
 
-					// If not matched, invoke `readCoil`
-					Modbus::Error error = readCoil(coilserver_id, coilIt->CoilAddress);
-					if(error != Modbus::SUCCESS)
-					{
-						Serial.printf("Watchdog: Failed to read coil %s: Error %02X\n",
-									  getCoilTypeName(request.type).c_str(),
-									  static_cast<int>(error));
-					}
+		if(nearest == INT32_MAX)
+			return portMAX_DELAY;
+		if(nearest <= 0)
+			return 0;
+		return pdMS_TO_TICKS((nearest + 999) / 1000);
+	}
+
+	void handleConfirmEvent(const CoilConfirmEvent& event)
+	{
+		switch(event.type)
+		{
+			case ConfirmEventType::ISSUED:
+			{
+				CoilConfirmation* slot = nullptr;
+				for(auto& entry: _pendingConfirms)
+				{
+					// A newer write to the same coils supersedes the older one
+					if(entry.active && (entry.coilMask & event.coilMask))
+						entry.active = false;
+					if(!entry.active && slot == nullptr)
+						slot = &entry;
+				}
+				if(slot == nullptr)
+				{
+					Serial.println("Watchdog: confirmation table full.");
+					return;
+				}
+				*slot = CoilConfirmation();
+				slot->token = event.token;
+				slot->coilMask = event.coilMask;
+				slot->expectedMask = event.valueMask;
+				slot->issued_us = event.at_us;
+				slot->deadline_us = event.at_us + COIL_CONFIRM_DEADLINE_MS * 1000;
+				slot->active = true;
+				break;
+			}
 
-					// Increment retries and delay
-					retries++;
-					vTaskDelay(pdMS_TO_TICKS(500)); // Adjust delay as needed
+			case ConfirmEventType::OBSERVED:
+			{
+				for(auto& entry: _pendingConfirms)
+				{
+					bool matches = event.readback ? entry.readbackIssued : entry.token == event.token;
+					if(!entry.active || !matches)
+						continue;
+
+					if(((event.valueMask ^ entry.expectedMask) & entry.coilMask) == 0)
+						confirmCoilWrite(entry, event.at_us);
+					else if(!entry.readbackIssued)
+						issueCoilReadback(entry);
+					else
+						failCoilWrite(entry, "readback mismatch");
 				}
+				break;
+			}
 
-				if(!matchFound)
+			case ConfirmEventType::FAILED:
+			{
+				for(auto& entry: _pendingConfirms)
 				{
-					Serial.printf("Watchdog: Timeout or retries exhausted for coil %s\n",
-								  getCoilTypeName(request.type).c_str());
+					if(!entry.active)
+						continue;
+					if(entry.token == event.token && !entry.readbackIssued)
+						issueCoilReadback(entry);
+					else if(entry.readbackIssued && entry.readToken == event.token)
+						failCoilWrite(entry, "readback error");
 				}
+				break;
+			}
 
-				// Reset state and wait for the next request
+			case ConfirmEventType::CANCELLED:
+			{
+				for(auto& entry: _pendingConfirms)
+				{
+					if(entry.active && entry.token == event.token)
+						entry.active = false;
+				}
+				break;
 			}
 		}
 	}
 
+	void expireConfirmations()
+	{
+		uint32_t now = micros();
+
+		for(auto& entry: _pendingConfirms)
+		{
+			if(!entry.active || static_cast<int32_t>(entry.deadline_us - now) > 0)
+				continue;
+
+			if(!entry.readbackIssued)
+				issueCoilReadback(entry);
+			else
+				failCoilWrite(entry, "deadline expired");
+		}
+	}
+
+	void issueCoilReadback(CoilConfirmation& entry)
+	{
+		entry.readbackIssued = true;
+		entry.deadline_us = micros() + COIL_READBACK_DEADLINE_MS * 1000;
+		_confirmStats.readbacks++;
+
+		entry.readToken = generateUniqueToken();
+		_coilBankRead.token = entry.readToken;
+		_coilBankRead.value = entry.expectedMask;
+
+		// The frame carries no token, so the cached one serves every readback
+		Modbus::Error error = Modbus::SUCCESS;
+		if(_coilReadbackFrame.size() == 0 ||
+		   _coilReadbackFrame.getServerID() != _coilBankRead.slave_id)
+		{
+			error = encodeRead(_coilBankRead, _coilReadbackFrame);
+		}
+		if(error == Modbus::SUCCESS)
+		{
+			// Any bank read requested after the write shows its result, including a poll
+			uint32_t sinceWrite_ms = (micros() - entry.issued_us) / 1000;
+			ModbusReadCache::Result cached;
+			error = submitRead(_coilBankRead, _coilReadbackFrame, sinceWrite_ms, cached);
+		}
+		if(error != Modbus::SUCCESS)
+		{
+			failCoilWrite(entry, "readback not queued");
+		}
+	}
+
+	void confirmCoilWrite(CoilConfirmation& entry, uint32_t at_us)
+	{
+		uint32_t latency_us = at_us - entry.issued_us;
+		entry.active = false;
+
+		_confirmStats.confirmed++;
+		_confirmStats.last_us = latency_us;
+		_confirmStats.max_us = std::max(_confirmStats.max_us, latency_us);
+		_confirmStats.total_us += latency_us;
+
+		if(MODBUS_DEBUG)
+		{
+			Serial.printf("Watchdog: coils %02X confirmed in %lu us%s\n", entry.coilMask,
+						  static_cast<unsigned long>(latency_us),
+						  entry.readbackIssued ? " (readback)" : "");
+		}
+	}
+
+	void failCoilWrite(CoilConfirmation& entry, const char* reason)
+	{
+		entry.active = false;
+		_confirmStats.failed++;
+		Serial.printf("Watchdog: coils %02X not confirmed: %s\n", entry.coilMask, reason);
+
+		// Drop the write caches so the next command for these coils reaches the wire
+		_lastCoilBankMask = COIL_MASK_UNKNOWN;
+		for(auto& target: _targets)
+		{
+			if(target.type == TargetType::SWITCH_CONTROL &&
+			   (entry.coilMask >> (target.start_address - COIL_BANK_START_ADDR)) & 0x01)
+			{
+				target.last_written_value = 0xFFFF;
+			}
+		}
+	}
+
+	void postConfirmEvent(ConfirmEventType type, uint32_t token, uint16_t coilMask,
+						  uint16_t valueMask, bool readback = false)
+	{
+		CoilConfirmEvent event = {type, token, coilMask, valueMask, static_cast<uint32_t>(micros()),
+								  readback};
+		if(xQueueSend(coilWatchdogQueue, &event, pdMS_TO_TICKS(10)) != pdTRUE)
+		{
+			Serial.println("Failed to enqueue watchdog event.");
+		}
+	}
+
 	// Data and error handlers
 	void handleData(ModbusMessage response, uint32_t token)
 	{
-		// Debug logging for full response details
-		Serial.printf("Response: ServerID=%d, FC=%d, Token=%08X, Length=%d\n",
-					  response.getServerID(), response.getFunctionCode(), token, response.size());
-
-		// Hex dump of response (optional, can be commented out in production)
-		for(auto& byte: response)
+		if(MODBUS_DEBUG)
 		{
-			Serial.printf("%02X ", byte);
+			// Debug logging for full response details
+			Serial.printf("Response: ServerID=%d, FC=%d, Token=%08X, Length=%d\n",
+						  response.getServerID(), response.getFunctionCode(), token,
+						  response.size());
+
+			// Hex dump of response
+			for(auto& byte: response)
+			{
+				Serial.printf("%02X ", byte);
+			}
+			Serial.println();
 		}
-		Serial.println();
 
+		completeRequest(token);
+
+		xSemaphoreTakeRecursive(targetMutex, portMAX_DELAY);
 		// Find the matching target by token
-		auto targetIt = std::find_if(_targets.begin(), _targets.end(), [&](const Target& t) {
-			return t.token == token;
-		});
+		Target* targetPtr = findTarget(token);
 
-		if(targetIt == _targets.end())
+		if(targetPtr == nullptr)
 		{
+			xSemaphoreGiveRecursive(targetMutex);
 			Serial.printf("Unknown target token %08X, ignoring response.\n", token);
 			return;
 		}
-		Target& target = *targetIt;
+		Target& target = *targetPtr;
+		_stats.onResponse(target.stats_slot);
+		TargetHealth* health = healthOf(target);
+		if(health != nullptr)
+		{
+			health->rtt.onSample(_stats.at(target.stats_slot).lastRtt_us);
+			health->breaker.onSuccess();
+		}
+		if(target.transport == ModbusTransport::TCP)
+		{
+			_tcpPool.reportSuccess(target.target_ip, MODBUS_TCP_PORT);
+		}
+
+		processResponse(target, response);
+
+		// Requesters that joined this read get the same reply
+		ModbusReadCache::Joiners joiners;
+		_readCache.store(token, response, joiners);
+		for(uint8_t i = 0; i < joiners.count; ++i)
+		{
+			deliverResponse(joiners.tokens[i], response);
+		}
+		xSemaphoreGiveRecursive(targetMutex);
+	}
+
+	void deliverResponse(uint32_t token, ModbusMessage& response)
+	{
+		xSemaphoreTakeRecursive(targetMutex, portMAX_DELAY);
+		Target* target = findTarget(token);
+		if(target != nullptr)
+		{
+			processResponse(*target, response);
+		}
+		xSemaphoreGiveRecursive(targetMutex);
+	}
+
+	void processResponse(Target& target, ModbusMessage& response)
+	{
+		const PollBlock* block = findMergedBlock(target.token);
+		if(block != nullptr)
+		{
+			splitBlockResponse(*block, response);
+			return;
+		}
 
 		// Process based on target type with improved error handling
 		switch(target.type)
 		{
 			case TargetType::INPUT_POWER:
+			case TargetType::OUTPUT_POWER:
+			case TargetType::POWER_METER:
 			{
-				if(!validateAndProcessPowerData(response, &inputPower))
+				size_t count = 0;
+				const uint16_t* words = registerWords(response, count);
+				if(words == nullptr)
 				{
-					Serial.println("Failed to process INPUT_POWER data.");
+					Serial.println("Response size is insufficient for parsing.");
 				}
-				break;
-			}
-
-			case TargetType::OUTPUT_POWER:
-			{
-				if(!validateAndProcessPowerData(response, &outputPower))
+				else
 				{
-					Serial.println("Failed to process OUTPUT_POWER data.");
+					processPowerWords(target, target, words, count);
 				}
 				break;
 			}
@@ -330,6 +728,12 @@ class ModbusManager
 				break;
 			}
 
+			case TargetType::COIL_READ:
+			{
+				processCoilReadResponse(response, target);
+				break;
+			}
+
 			default:
 			{
 				Serial.printf("Unhandled target type: %d\n", static_cast<int>(target.type));
@@ -342,6 +746,154 @@ class ModbusManager
 	{
 		ModbusError me(error);
 		Serial.printf("Error response: %02X - %s\n", (int)me, (const char*)me);
+		completeRequest(token);
+
+		xSemaphoreTakeRecursive(targetMutex, portMAX_DELAY);
+		Target* target = findTarget(token);
+		if(target != nullptr)
+		{
+			_stats.onError(target->stats_slot, error);
+			updateHealth(*target, error);
+		}
+		if(target != nullptr && target->transport == ModbusTransport::TCP &&
+		   error == Modbus::Error::IP_CONNECTION_FAILED)
+		{
+			_tcpPool.reportFailure(target->target_ip, MODBUS_TCP_PORT);
+		}
+		if(target != nullptr &&
+		   (target->type == TargetType::SWITCH_CONTROL || target->type == TargetType::COIL_READ))
+		{
+			postConfirmEvent(ConfirmEventType::FAILED, token, 0, 0);
+		}
+		failJoiners(token);
+		xSemaphoreGiveRecursive(targetMutex);
+	}
+
+	// A read others joined is not coming back; coil readbacks among them must hear of it
+	void failJoiners(uint32_t token)
+	{
+		ModbusReadCache::Joiners joiners;
+		_readCache.fail(token, joiners);
+		xSemaphoreTakeRecursive(targetMutex, portMAX_DELAY);
+		for(uint8_t i = 0; i < joiners.count; ++i)
+		{
+			Target* target = findTarget(joiners.tokens[i]);
+			if(target != nullptr && target->type == TargetType::COIL_READ)
+			{
+				postConfirmEvent(ConfirmEventType::FAILED, joiners.tokens[i], 0, 0);
+			}
+		}
+		xSemaphoreGiveRecursive(targetMutex);
+	}
+
+	// Hands scheduled requests to eModbus, highest class first. Woken by every submit and
+	// every completion, since either can make the next request eligible.
+	void dispatchTask()
+	{
+		ModbusScheduler<Target>::Entry entry;
+		while(true)
+		{
+			ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(DISPATCH_IDLE_MS));
+			while(_scheduler.next(entry))
+			{
+				bool deferred = false;
+				Modbus::Error error = dispatchRequest(entry.target, entry.message, deferred);
+				if(error != Modbus::SUCCESS)
+				{
+					_scheduler.complete(entry.target.token);
+					handleDispatchFailure(entry.target, error, deferred);
+				}
+			}
+		}
+	}
+
+	// Queue a request in its target's priority class
+	Modbus::Error submitRequest(const Target& target, const ModbusMessage& request)
+	{
+		if(!_scheduler.enqueue(target.priority, target, request))
+		{
+			return Modbus::Error::REQUEST_QUEUE_FULL;
+		}
+		if(dispatchTaskHandle != NULL)
+		{
+			xTaskNotifyGive(dispatchTaskHandle);
+		}
+		return Modbus::SUCCESS;
+	}
+
+	// Reads go through the cache first: a young enough reply is handed over directly and a
+	// read already on the bus is joined, so only a miss reaches the scheduler
+	Modbus::Error submitRead(const Target& target, const ModbusMessage& frame, uint32_t ttl_ms,
+							 ModbusReadCache::Result& result)
+	{
+		ModbusMessage cached;
+		result = _readCache.lookup(readKey(target), ttl_ms, target.token, cached);
+		if(result == ModbusReadCache::Result::HIT)
+		{
+			if(cached.size() != 0)
+				deliverResponse(target.token, cached);
+			return Modbus::SUCCESS;
+		}
+		if(result == ModbusReadCache::Result::JOINED)
+		{
+			return Modbus::SUCCESS;
+		}
+
+		Modbus::Error error = submitRequest(target, frame);
+		_planStats.framesReused++;
+		if(error != Modbus::SUCCESS)
+		{
+			failJoiners(target.token);
+		}
+		return error;
+	}
+
+	static ReadKey readKey(const Target& target)
+	{
+		ReadKey key;
+		key.ip = target.transport == ModbusTransport::TCP ? static_cast<uint32_t>(target.target_ip)
+														  : 0;
+		key.slave = target.slave_id;
+		key.function = target.function_code;
+		key.start = target.start_address;
+		key.length = target.length;
+		return key;
+	}
+
+	void completeRequest(uint32_t token)
+	{
+		_scheduler.complete(token);
+		if(dispatchTaskHandle != NULL)
+		{
+			xTaskNotifyGive(dispatchTaskHandle);
+		}
+	}
+
+	// eModbus refused the request, or the pool held it back, so no callback will follow for it
+	void handleDispatchFailure(const Target& target, Error error, bool deferred)
+	{
+		// Runs on the dispatch task; the breaker is shared with the callbacks and the poll loop
+		xSemaphoreTakeRecursive(targetMutex, portMAX_DELAY);
+		if(deferred)
+		{
+			// Endpoint backing off after a failure that was already counted once
+			TargetHealth* health = healthOf(target);
+			if(health != nullptr)
+				health->breaker.cancelProbe();
+		}
+		else
+		{
+			ModbusError me(error);
+			Serial.printf("Request %08X not sent: %02X - %s\n", target.token, (int)me,
+						  (const char*)me);
+			updateHealth(target, error);
+		}
+		failJoiners(target.token);
+		if(target.type == TargetType::SWITCH_CONTROL || target.type == TargetType::COIL_READ)
+		{
+			postConfirmEvent(ConfirmEventType::FAILED, target.token, 0, 0);
+		}
+		xSemaphoreGiveRecursive(targetMutex);
 	}
 
   public:
@@ -352,6 +904,54 @@ class ModbusManager
 		return instance;
 	}
 
+	// Line settings for targets with ModbusTransport::RTU. Serial2 and the DE pin stay free
+	// until the first such target is added.
+	void configureRTU(const SetupModbus& config)
+	{
+		_rtuConfig = config;
+	}
+
+	// Bring up the RS485 bus for targets with ModbusTransport::RTU. Line settings come from
+	// SetupModbus; the inter-frame gap is derived from them.
+	bool beginRTU(const SetupModbus& config)
+	{
+		if(RTUClient)
+		{
+			return true;
+		}
+
+		uint32_t serialConfig = rtuSerialConfig(config);
+		if(serialConfig == 0)
+		{
+			Serial.printf("Unsupported RTU line setting %u data bits, parity %u, %u stop bits\n",
+						  config.databits, config.parity, config.stopbits);
+			return false;
+		}
+
+		RTUutils::prepareHardwareSerial(Serial2);
+		Serial2.begin(config.baudrate, serialConfig, RX_RS485_PIN, TX_RS485_PIN);
+
+		RTUClient = std::unique_ptr<ModbusClientRTU>(new ModbusClientRTU(RS485_RTS_PIN));
+		RTUClient->setTimeout(_timeout);
+		RTUClient->onDataHandler([this](ModbusMessage response, uint32_t token) {
+			this->handleData(response, token);
+		});
+		RTUClient->onErrorHandler([this](Error error, uint32_t token) {
+			this->handleError(error, token);
+		});
+
+		uint32_t interval_us = rtuFrameInterval(config);
+		RTUClient->begin(Serial2, -1, interval_us);
+		Serial.printf("Modbus RTU started at %lu baud, frame gap %lu us\n", config.baudrate,
+					  static_cast<unsigned long>(interval_us));
+		return true;
+	}
+
+	static uint32_t rtuFrameInterval(const SetupModbus& config)
+	{
+		return rtuFrameGapUs(config.baudrate, config.databits, config.parity, config.stopbits);
+	}
+
 	// Base case (end of recursion)
 	void processTarget(bool startPolling)
 	{
@@ -380,13 +980,89 @@ class ModbusManager
 			stopPollingTask();
 	}
 
-	OutBox& getInputPower()
+	// Meters must be registered before targets that reference their id are added
+	bool registerMeter(const NamePlate& plate, MeterRole role)
+	{
+		if(!_meters.add(plate, role))
+		{
+			Serial.printf("Meter %u not registered (duplicate, unset or registry full)\n",
+						  plate.id);
+			return false;
+		}
+		return true;
+	}
+
+	// Call after the meters are registered; later changes arrive through onSettingsUpdate
+	void setCalibration(const Node_Core::SetupCalibration& calibration)
+	{
+		xSemaphoreTake(meterMutex, portMAX_DELAY);
+		_meters.setCalibration(calibration);
+		xSemaphoreGive(meterMutex);
+		Serial.printf("Meter calibration v%u applied (%u channels)\n", calibration.version,
+					  calibration.channelCount);
+	}
+
+	// Streaming side asks to be woken as soon as a meter reading is published
+	void setSnapshotListener(TaskHandle_t task, uint32_t bits)
+	{
+		_snapshotBits = bits;
+		_snapshotListener = task;
+	}
+
+	void onSettingsUpdate(Node_Core::SettingType type, const void* settings) override
+	{
+		if(type == Node_Core::SettingType::CALIBRATION)
+			setCalibration(*static_cast<const Node_Core::SetupCalibration*>(settings));
+	}
+
+	// Readings are copied out under meterMutex, so a reader never sees one half-published
+	OutBox getMeter(uint8_t meterId)
+	{
+		xSemaphoreTake(meterMutex, portMAX_DELAY);
+		const OutBox* outbox = _meters.measure(meterId);
+		OutBox reading = outbox != nullptr ? *outbox : OutBox(); // Role has no meter yet
+		xSemaphoreGive(meterMutex);
+		return reading;
+	}
+
+	// Single-phase view kept for the dashboard; three-phase callers use aggregate()
+	OutBox getInputPower()
 	{
-		return inputPower;
+		return getMeter(_meters.primary(MeterRole::INPUT));
 	}
-	OutBox& getoutputPower()
+	OutBox getoutputPower()
 	{
-		return outputPower;
+		return getMeter(_meters.primary(MeterRole::OUTPUT));
+	}
+
+	OutBox aggregate(MeterRole role)
+	{
+		xSemaphoreTake(meterMutex, portMAX_DELAY);
+		OutBox total = _meters.aggregate(role);
+		xSemaphoreGive(meterMutex);
+		return total;
+	}
+
+	// Calibration both primary readings were corrected with; 0 when uncorrected or mixed
+	uint16_t calibrationVersion()
+	{
+		xSemaphoreTake(meterMutex, portMAX_DELAY);
+		uint16_t input = _meters.aggregate(MeterRole::INPUT).calibrationVersion;
+		uint16_t output = _meters.aggregate(MeterRole::OUTPUT).calibrationVersion;
+		xSemaphoreGive(meterMutex);
+		return input == output ? input : 0;
+	}
+
+	// visit(info, reading) for every meter in slot order, under meterMutex; keep it short
+	template<typename Visit>
+	void forEachMeter(Visit visit)
+	{
+		xSemaphoreTake(meterMutex, portMAX_DELAY);
+		for(size_t slot = 0; slot < _meters.size(); ++slot)
+		{
+			visit(_meters.infoAt(slot), _meters.measureAt(slot));
+		}
+		xSemaphoreGive(meterMutex);
 	}
 
 	void TriggerCoil(CoilType type, CoilState state)
@@ -402,60 +1078,231 @@ class ModbusManager
 			return;
 		}
 
-		// Set the coil value
+		// Set the coil value; the watchdog confirms it from the write echo
 		uint8_t serverID = coilserver_id;
 		uint16_t address = coilIt->CoilAddress;
 		bool value = (state == CoilState::ON);
 
 		Modbus::Error error = setCoil(serverID, address, value);
 
-		if(error != Modbus::SUCCESS)
+		if(error != Modbus::SUCCESS)
+		{
+			Serial.printf("Failed to set coil %s: Error %02X\n", getCoilTypeName(type).c_str(),
+						  static_cast<int>(error));
+		}
+	}
+
+	const CoilConfirmStats& getCoilConfirmStats() const
+	{
+		return _confirmStats;
+	}
+	// Per-target RTT histograms and error counters, indexed by Target::stats_slot
+	const ModbusStats& getStats() const
+	{
+		return _stats;
+	}
+
+	// Requests waiting in the scheduler, queued in a client or in flight
+	uint32_t pendingRequests()
+	{
+		uint32_t pending = _tcpPool.pendingRequests() + _scheduler.queuedTotal();
+		if(RTUClient)
+			pending += RTUClient->pendingRequests();
+		return pending;
+	}
+
+	// RTT estimate and breaker for a Target::stats_slot, nullptr for untracked slots
+	const TargetHealth* getHealth(uint8_t slot) const
+	{
+		return slot < _stats.size() ? &_health[slot] : nullptr;
+	}
+
+	// Called from StateMachine::NotifyStateChanged
+	void updateState(Node_Core::State state)
+	{
+		_nodeState.store(state);
+		wakePoller();
+	}
+
+	// Called by TestSync when it starts or stops a test
+	void updateTest(TestType test, bool running)
+	{
+		_activeTest.store(test);
+		_testActive.store(running);
+		if(running)
+		{
+			resetEfficiency();
+		}
+		wakePoller();
+	}
+
+	EfficiencySnapshot getEfficiency()
+	{
+		EfficiencySnapshot snapshot;
+		xSemaphoreTake(samplingMutex, portMAX_DELAY);
+		snapshot.count = _efficiency.count();
+		snapshot.mean = _efficiency.mean();
+		snapshot.stddev = _efficiency.stddev();
+		snapshot.ci95 = _efficiency.ci95();
+		snapshot.paired = _sampler.paired();
+		snapshot.rejected = _sampler.rejected();
+		snapshot.lastPair = _lastPair;
+		xSemaphoreGive(samplingMutex);
+		return snapshot;
+	}
+
+	void resetEfficiency()
+	{
+		xSemaphoreTake(samplingMutex, portMAX_DELAY);
+		_sampler.reset();
+		_efficiency.reset();
+		_lastPair = AlignedPair();
+		xSemaphoreGive(samplingMutex);
+	}
+
+	const PollProfile& getPollProfile() const
+	{
+		return *_profile.load();
+	}
+
+	// Per-class queue and latency counters of the request scheduler
+	const ModbusScheduler<Target>::ClassStats& getClassStats(RequestPriority priority) const
+	{
+		return _scheduler.stats(priority);
+	}
+	size_t getQueuedRequests(RequestPriority priority) const
+	{
+		return _scheduler.queued(priority);
+	}
+
+	// Requests per polling cycle and how often cached frames were reused
+	const PollPlanStats& getPollPlanStats() const
+	{
+		return _planStats;
+	}
+
+	// Read-through cache hits, joins and misses across polls and coil readbacks
+	const ModbusReadCache::Stats& getReadCacheStats() const
+	{
+		return _readCache.stats();
+	}
+
+	// Connection churn across the pooled TCP endpoints
+	const ModbusTcpPool::Stats& getTcpPoolStats() const
+	{
+		return _tcpPool.stats();
+	}
+
+	// Switch several coils at once with one FC 0x0F write for the whole bank; the watchdog
+	// confirms it from the echo. Coils not named in commands keep their last known state.
+	void TriggerCoils(std::initializer_list<CoilCommand> commands)
+	{
+		xSemaphoreTakeRecursive(targetMutex, portMAX_DELAY);
+		uint16_t mask = currentCoilMask();
+
+		for(const auto& command: commands)
+		{
+			auto coilIt = std::find_if(_coils.begin(), _coils.end(), [&](const TesterCoil& coil) {
+				return coil.type == command.type;
+			});
+
+			if(coilIt == _coils.end())
+			{
+				xSemaphoreGiveRecursive(targetMutex);
+				Serial.printf("Invalid Coil Type: %d\n", static_cast<int>(command.type));
+				return;
+			}
+
+			uint16_t bit = 1 << (coilIt->CoilAddress - COIL_BANK_START_ADDR);
+			if(command.state == CoilState::ON)
+				mask |= bit;
+			else
+				mask &= ~bit;
+		}
+
+		if(mask == _lastCoilBankMask)
 		{
-			Serial.printf("Failed to set coil %s: Error %02X\n", getCoilTypeName(type).c_str(),
-						  static_cast<int>(error));
-			return;
+			xSemaphoreGiveRecursive(targetMutex);
+			return; // Bank already in the requested state
 		}
 
-		// Prepare the watchdog request
-		WatchdogRequest request = {type, state, 5000}; // 5-second timeout
-
-		// Send the request to the queue
-		if(xQueueSend(coilWatchdogQueue, &request, pdMS_TO_TICKS(100)) != pdTRUE)
+		Modbus::Error error = writeCoilBank(coilserver_id, mask);
+		xSemaphoreGiveRecursive(targetMutex);
+		if(error != Modbus::SUCCESS)
 		{
-			Serial.println("Failed to enqueue watchdog request.");
+			Serial.printf("Failed to write coil bank mask %02X: Error %02X\n", mask,
+						  static_cast<int>(error));
 		}
 	}
 
   private:
 	// Add a target to the list
+	static bool isPowerTarget(const Target& target)
+	{
+		return target.type == TargetType::INPUT_POWER || target.type == TargetType::OUTPUT_POWER ||
+			   target.type == TargetType::POWER_METER;
+	}
+
+	// Token 0 means "assign one", so such targets are matched on where they point instead
+	static bool sameTarget(const Target& a, const Target& b)
+	{
+		if(b.token != 0)
+			return a.type == b.type && a.token == b.token;
+		return a.type == b.type && a.target_ip == b.target_ip && a.slave_id == b.slave_id &&
+			   a.function_code == b.function_code && a.start_address == b.start_address;
+	}
+
 	void addTarget(const Target& target)
 	{
+		xSemaphoreTakeRecursive(targetMutex, portMAX_DELAY);
 		// Check for duplicates
-		auto it = std::find_if(_targets.begin(), _targets.end(), [&](const Target& t) {
-			return t.type == target.type && t.token == target.token;
-		});
+		auto it = std::find_if(_targets.begin(), _targets.end(),
+							   [&](const Target& t) { return sameTarget(t, target); });
 
 		if(it == _targets.end())
 		{
-			_targets.push_back(target);
-			Serial.printf("Target added: Token=%08X, Type=%d, IP=%s\n", target.token,
-						  static_cast<int>(target.type), target.target_ip.toString().c_str());
+			Target added = target;
+			if(added.token == 0)
+			{
+				added.token = generateUniqueToken();
+			}
+			if(added.transport == ModbusTransport::RTU && !beginRTU(_rtuConfig))
+			{
+				xSemaphoreGiveRecursive(targetMutex);
+				Serial.printf("Target %08X not added: RS485 bus unavailable\n", added.token);
+				return;
+			}
+			if(isPowerTarget(added) && added.meter_id == MeterRegistry::NO_METER)
+			{
+				registerLegacyMeter(added);
+			}
+			if(added.type == TargetType::SWITCH_CONTROL || added.type == TargetType::COIL_READ)
+			{
+				added.priority = RequestPriority::CONTROL;
+			}
+			trackTarget(added);
+			_targets.push_back(added);
+			rebuildPollPlan();
+			Serial.printf("Target added: Token=%08X, Type=%d, IP=%s\n", added.token,
+						  static_cast<int>(added.type), added.target_ip.toString().c_str());
 		}
 		else
 		{
 			Serial.printf("Duplicate target ignored: Token=%08X\n", target.token);
 		}
+		xSemaphoreGiveRecursive(targetMutex);
 	}
 	void removeTarget(const Target& target)
 	{
+		xSemaphoreTakeRecursive(targetMutex, portMAX_DELAY);
 		// Find the target using the same criteria as addTarget
-		auto it = std::find_if(_targets.begin(), _targets.end(), [&](const Target& t) {
-			return t.type == target.type && t.token == target.token;
-		});
+		auto it = std::find_if(_targets.begin(), _targets.end(),
+							   [&](const Target& t) { return sameTarget(t, target); });
 
 		if(it != _targets.end())
 		{
 			_targets.erase(it);
+			rebuildPollPlan();
 			Serial.printf("Target removed: Token=%08X, Type=%d, IP=%s\n", target.token,
 						  static_cast<int>(target.type), target.target_ip.toString().c_str());
 		}
@@ -463,6 +1310,106 @@ class ModbusManager
 		{
 			Serial.printf("Target not found for removal: Token=%08X\n", target.token);
 		}
+		xSemaphoreGiveRecursive(targetMutex);
+	}
+
+	void trackTarget(Target& target)
+	{
+		target.stats_slot =
+			_stats.assign(target.target_ip, target.slave_id, target.function_code,
+						  target.start_address, static_cast<uint8_t>(target.type));
+		// The configured timeout is the starting RTO and its ceiling
+		TargetHealth* health = healthOf(target);
+		if(health != nullptr)
+			health->rtt.setBounds(_timeout, _timeout);
+	}
+
+	TargetHealth* healthOf(const Target& target)
+	{
+		return target.stats_slot < _stats.size() ? &_health[target.stats_slot] : nullptr;
+	}
+
+	// Timeouts and unreachable devices count against the breaker; an exception reply still
+	// proves the device is alive, so it closes it like a normal response.
+	void updateHealth(const Target& target, Error error)
+	{
+		TargetHealth* health = healthOf(target);
+		if(health == nullptr)
+			return;
+
+		if(error == Modbus::TIMEOUT)
+		{
+			health->rtt.onTimeout();
+			health->breaker.onFailure();
+		}
+		else if(error == Modbus::IP_CONNECTION_FAILED || error == Modbus::GATEWAY_PATH_UNAVAIL ||
+				error == Modbus::GATEWAY_TARGET_NO_RESP)
+		{
+			health->breaker.onFailure();
+		}
+		else if(ModbusStats::isException(error))
+		{
+			health->breaker.onSuccess();
+		}
+	}
+
+	// Reading time is taken as the middle of the round trip, which is closer to when the
+	// meter latched its registers than the moment the reply arrived.
+	uint32_t sampleTime(const Target& target) const
+	{
+		if(target.stats_slot >= _stats.size())
+			return micros();
+		const ModbusTargetStats& stats = _stats.at(target.stats_slot);
+		return stats.issued_us + stats.lastRtt_us / 2;
+	}
+
+	// Feed the role total into the sampler, so three-phase groups pair on total power. The
+	// reading is timed by the request that carried it, which is the block for merged reads.
+	void recordPowerSample(const Target& target, const Target& wire, const OutBox& input,
+						   const OutBox& output)
+	{
+		const MeterRegistry::MeterInfo* info = _meters.info(target.meter_id);
+		if(info == nullptr || (info->role != MeterRole::INPUT && info->role != MeterRole::OUTPUT))
+			return;
+
+		float power = info->role == MeterRole::INPUT ? input.power : output.power;
+		uint32_t at_us = sampleTime(wire);
+		AlignedPair pair;
+
+		xSemaphoreTake(samplingMutex, portMAX_DELAY);
+		bool paired = info->role == MeterRole::INPUT ? _sampler.addInput(power, at_us, pair)
+													 : _sampler.addOutput(power, at_us, pair);
+		if(paired)
+		{
+			_lastPair = pair;
+			_efficiency.add(pair);
+		}
+		float mean = _efficiency.mean();
+		float ci95 = _efficiency.ci95();
+		uint32_t count = _efficiency.count();
+		xSemaphoreGive(samplingMutex);
+
+		if(paired)
+		{
+			ModbusStatusServer::getInstance().publishEfficiency(mean, ci95, count);
+		}
+	}
+
+	// INPUT_POWER/OUTPUT_POWER targets without a meter_id get a single-phase meter keyed by
+	// their slave id, which is how the two-channel setup behaved before the registry.
+	void registerLegacyMeter(Target& target)
+	{
+		target.meter_id = target.slave_id;
+		if(_meters.contains(target.meter_id))
+			return;
+
+		NamePlate plate;
+		plate.model = PZEMModel::PZEM004T;
+		plate.id = target.meter_id;
+		plate.slaveAddress = target.slave_id;
+		MeterRole role =
+			target.type == TargetType::OUTPUT_POWER ? MeterRole::OUTPUT : MeterRole::INPUT;
+		registerMeter(plate, role);
 	}
 
 	//
@@ -496,7 +1443,7 @@ class ModbusManager
 		Target load_bank_2_trigger = {
 			TargetType::SWITCH_CONTROL, // type
 			pzemServerIP, // target_ip
-			3, // slave_id
+			coilserver_id, // slave_id
 			Modbus::FunctionCode::WRITE_COIL, // function_code
 			ModbusManager::LOAD_BANK_2_COIL_ADDR, // start_address
 			generateUniqueToken(), // token
@@ -508,7 +1455,7 @@ class ModbusManager
 		Target load_bank_3_trigger = {
 			TargetType::SWITCH_CONTROL, // type
 			pzemServerIP, // target_ip
-			3, // slave_id
+			coilserver_id, // slave_id
 			Modbus::FunctionCode::WRITE_COIL, // function_code
 			ModbusManager::LOAD_BANK_3_COIL_ADDR, // start_address
 			generateUniqueToken(), // token
@@ -520,7 +1467,7 @@ class ModbusManager
 		Target test_update_trigger = {
 			TargetType::SWITCH_CONTROL, // type
 			pzemServerIP, // target_ip
-			3, // slave_id
+			coilserver_id, // slave_id
 			Modbus::FunctionCode::WRITE_COIL, // function_code
 			ModbusManager::TEST_UPDATE_COIL_ADDR, // start_address
 			generateUniqueToken(), // token
@@ -533,55 +1480,439 @@ class ModbusManager
 		addTarget(load_bank_2_trigger);
 		addTarget(load_bank_3_trigger);
 		addTarget(test_update_trigger);
+
+		// Bank-wide write and readback, kept out of _targets so the poller never picks them up
+		_coilBankWrite = {
+			TargetType::SWITCH_CONTROL, // type
+			pzemServerIP, // target_ip
+			coilserver_id, // slave_id
+			Modbus::FunctionCode::WRITE_MULT_COILS, // function_code
+			COIL_BANK_START_ADDR, // start_address
+			generateUniqueToken(), // token
+			MAX_COILS, // length
+			0, // value (coil mask)
+			COIL_MASK_UNKNOWN // last_written_value
+		};
+		_coilBankRead = {
+			TargetType::COIL_READ, // type
+			pzemServerIP, // target_ip
+			coilserver_id, // slave_id
+			Modbus::FunctionCode::READ_COIL, // function_code
+			COIL_BANK_START_ADDR, // start_address
+			generateUniqueToken(), // token
+			MAX_COILS, // length
+			0, // value (expected coil mask)
+			COIL_MASK_UNKNOWN // last_written_value
+		};
+		_coilBankWrite.priority = RequestPriority::CONTROL;
+		_coilBankRead.priority = RequestPriority::CONTROL;
+		trackTarget(_coilBankWrite);
+		trackTarget(_coilBankRead);
+
+		// Single-coil writes only ever carry 0x0000 or 0xFF00, so both frames are kept
+		for(uint16_t address = 0; address < MAX_COILS; ++address)
+		{
+			_coilFrames[address][0].setMessage(coilserver_id, Modbus::FunctionCode::WRITE_COIL,
+											   COIL_BANK_START_ADDR + address, 0x0000);
+			_coilFrames[address][1].setMessage(coilserver_id, Modbus::FunctionCode::WRITE_COIL,
+											   COIL_BANK_START_ADDR + address, 0xFF00);
+			_planStats.framesEncoded += 2;
+		}
+		encodeRead(_coilBankRead, _coilReadbackFrame);
+	}
+
+	// Callers hold targetMutex for as long as they use the result
+	Target* findTarget(uint32_t token)
+	{
+		auto it = std::find_if(_targets.begin(), _targets.end(), [&](const Target& t) {
+			return t.token == token;
+		});
+		if(it != _targets.end())
+			return &(*it);
+		if(_coilBankWrite.token == token)
+			return &_coilBankWrite;
+		if(_coilBankRead.token == token)
+			return &_coilBankRead;
+		for(auto& block: _pollPlan)
+		{
+			if(block.memberCount > 1 && block.wire.token == token)
+				return &block.wire;
+		}
+		return nullptr;
+	}
+
+	const PollBlock* findMergedBlock(uint32_t token) const
+	{
+		for(const auto& block: _pollPlan)
+		{
+			if(block.memberCount > 1 && block.wire.token == token)
+				return &block;
+		}
+		return nullptr;
+	}
+
+	static bool isRegisterRead(const Target& target)
+	{
+		return target.function_code == Modbus::READ_HOLD_REGISTER ||
+			   target.function_code == Modbus::READ_INPUT_REGISTER;
+	}
+
+	// Whether target can join block: same device and function, range touching or overlapping
+	// the block's, and the union still fits one request
+	static bool canMerge(const PollBlock& block, const Target& target)
+	{
+		const Target& wire = block.wire;
+		if(block.memberCount >= MAX_BLOCK_MEMBERS || !isRegisterRead(target) ||
+		   !isPowerTarget(target) || !isPowerTarget(wire) || target.transport != wire.transport ||
+		   target.target_ip != wire.target_ip || target.slave_id != wire.slave_id ||
+		   target.function_code != wire.function_code)
+			return false;
+
+		uint32_t blockEnd = wire.start_address + wire.length;
+		uint32_t targetEnd = target.start_address + target.length;
+		if(target.start_address > blockEnd || wire.start_address > targetEnd)
+			return false;
+
+		uint32_t start = wire.start_address < target.start_address ? wire.start_address
+																	 : target.start_address;
+		uint32_t end = blockEnd > targetEnd ? blockEnd : targetEnd;
+		return end - start <= MAX_BLOCK_REGISTERS;
+	}
+
+	Modbus::Error encodeRead(const Target& target, ModbusMessage& frame)
+	{
+		_planStats.framesEncoded++;
+		return frame.setMessage(target.slave_id, target.function_code, target.start_address,
+								target.length);
+	}
+
+	// Group the polled targets into blocks and encode each block's frame once. Targets are
+	// visited in address order so a range bridging two others still lands in one block.
+	// Callers hold targetMutex across the change to _targets and this rebuild.
+	void rebuildPollPlan()
+	{
+		std::vector<uint8_t> order;
+		for(size_t i = 0; i < _targets.size() && i < 0xFF; ++i)
+		{
+			if(isPowerTarget(_targets[i]) || _targets[i].type == TargetType::COIL_READ)
+				order.push_back(static_cast<uint8_t>(i));
+		}
+		std::sort(order.begin(), order.end(), [this](uint8_t a, uint8_t b) {
+			const Target& x = _targets[a];
+			const Target& y = _targets[b];
+			if(x.slave_id != y.slave_id)
+				return x.slave_id < y.slave_id;
+			if(x.function_code != y.function_code)
+				return x.function_code < y.function_code;
+			return x.start_address < y.start_address;
+		});
+
+		std::vector<PollBlock> plan;
+		for(uint8_t index: order)
+		{
+			const Target& target = _targets[index];
+			PollBlock* block = nullptr;
+			for(auto& candidate: plan)
+			{
+				if(canMerge(candidate, target))
+				{
+					block = &candidate;
+					break;
+				}
+			}
+
+			if(block == nullptr)
+			{
+				plan.emplace_back();
+				block = &plan.back();
+				block->wire = target;
+			}
+			else
+			{
+				uint32_t end = block->wire.start_address + block->wire.length;
+				uint32_t targetEnd = target.start_address + target.length;
+				if(target.start_address < block->wire.start_address)
+					block->wire.start_address = target.start_address;
+				block->wire.length =
+					static_cast<uint16_t>((end > targetEnd ? end : targetEnd) -
+										  block->wire.start_address);
+			}
+			block->members[block->memberCount++] = index;
+		}
+
+		for(auto& block: plan)
+		{
+			if(block.memberCount > 1)
+			{
+				// One wire request for several meters: own token, stats and breaker. A block
+				// that did not change keeps its token, so a reply already on the way still lands.
+				const PollBlock* previous = findSameBlock(block);
+				if(previous != nullptr)
+				{
+					block.wire.token = previous->wire.token;
+					block.wire.stats_slot = previous->wire.stats_slot;
+					block.wire.meter_id = MeterRegistry::NO_METER;
+					block.frame = previous->frame;
+					block.frameError = previous->frameError;
+					continue;
+				}
+				block.wire.token = generateUniqueToken();
+				block.wire.meter_id = MeterRegistry::NO_METER;
+				trackTarget(block.wire);
+				Serial.printf("Merged %u reads on slave %u into %u registers from %u\n",
+							  block.memberCount, block.wire.slave_id, block.wire.length,
+							  block.wire.start_address);
+			}
+			block.frameError = encodeRead(block.wire, block.frame);
+		}
+
+		_pollPlan.swap(plan);
+		_planStats.blocks = _pollPlan.size();
+		_planStats.targets = order.size();
+	}
+
+	// Merged block of the current plan reading the same registers from the same device
+	const PollBlock* findSameBlock(const PollBlock& block) const
+	{
+		const Target& wire = block.wire;
+		for(const auto& candidate: _pollPlan)
+		{
+			const Target& other = candidate.wire;
+			if(candidate.memberCount > 1 && other.transport == wire.transport &&
+			   other.target_ip == wire.target_ip && other.slave_id == wire.slave_id &&
+			   other.function_code == wire.function_code &&
+			   other.start_address == wire.start_address && other.length == wire.length)
+				return &candidate;
+		}
+		return nullptr;
+	}
+
+	// Hand each member of a merged read its slice of the reply
+	void splitBlockResponse(const PollBlock& block, const ModbusMessage& response)
+	{
+		size_t count = 0;
+		const uint16_t* words = registerWords(response, count);
+		if(words == nullptr || count < block.wire.length)
+		{
+			Serial.printf("Merged read %08X returned %u of %u registers\n", block.wire.token,
+						  static_cast<unsigned>(count), block.wire.length);
+			return;
+		}
+
+		for(uint8_t i = 0; i < block.memberCount; ++i)
+		{
+			const Target& member = _targets[block.members[i]];
+			size_t offset = member.start_address - block.wire.start_address;
+			processPowerWords(member, block.wire, words + offset, member.length);
+		}
+	}
+
+	// Route a request to the client that owns the target's transport; deferred as for
+	// ModbusTcpPool::addRequest
+	Modbus::Error dispatchRequest(const Target& target, const ModbusMessage& request,
+								  bool& deferred)
+	{
+		deferred = false;
+		Modbus::Error result;
+		xSemaphoreTakeRecursive(targetMutex, portMAX_DELAY);
+		const TargetHealth* health = getHealth(target.stats_slot);
+		uint32_t timeout_ms = health != nullptr ? health->rtt.rtoMs() : _timeout;
+		if(target.transport == ModbusTransport::RTU)
+			timeout_ms = rtuBusTimeout();
+		xSemaphoreGiveRecursive(targetMutex);
+		if(target.transport == ModbusTransport::RTU)
+		{
+			if(RTUClient)
+			{
+				RTUClient->setTimeout(timeout_ms);
+				result = RTUClient->addRequest(request, target.token);
+			}
+			else
+			{
+				result = Modbus::Error::INVALID_SERVER;
+			}
+		}
+		else
+		{
+			result = _tcpPool.addRequest(target.target_ip, MODBUS_TCP_PORT, request, target.token,
+										 timeout_ms, deferred);
+		}
+		xSemaphoreTakeRecursive(targetMutex, portMAX_DELAY);
+		_stats.onIssued(target.stats_slot, result);
+		xSemaphoreGiveRecursive(targetMutex);
+		return result;
+	}
+
+	// eModbus RTU has one timeout for the whole bus, read when a request goes on the wire rather
+	// than when it is queued, so it follows the slowest RTU target's adaptive RTO: a fast
+	// slave's RTO must not cut short a slow one queued behind it. Callers hold targetMutex.
+	uint32_t rtuBusTimeout() const
+	{
+		uint32_t timeout_ms = 0;
+		auto consider = [this, &timeout_ms](const Target& target) {
+			const TargetHealth* health = getHealth(target.stats_slot);
+			if(target.transport == ModbusTransport::RTU && health != nullptr)
+				timeout_ms = std::max(timeout_ms, health->rtt.rtoMs());
+		};
+		for(const Target& target: _targets)
+			consider(target);
+		for(const PollBlock& block: _pollPlan)
+			consider(block.wire);
+		return timeout_ms != 0 ? timeout_ms : _timeout;
+	}
+
+	static uint32_t rtuSerialConfig(const SetupModbus& config)
+	{
+		// parity: 0 = none, 1 = odd, 2 = even
+		if(config.databits == 8)
+		{
+			if(config.parity == 0)
+				return config.stopbits == 2 ? SERIAL_8N2 : SERIAL_8N1;
+			if(config.parity == 1)
+				return config.stopbits == 2 ? SERIAL_8O2 : SERIAL_8O1;
+			if(config.parity == 2)
+				return config.stopbits == 2 ? SERIAL_8E2 : SERIAL_8E1;
+		}
+		else if(config.databits == 7)
+		{
+			if(config.parity == 0)
+				return config.stopbits == 2 ? SERIAL_7N2 : SERIAL_7N1;
+			if(config.parity == 1)
+				return config.stopbits == 2 ? SERIAL_7O2 : SERIAL_7O1;
+			if(config.parity == 2)
+				return config.stopbits == 2 ? SERIAL_7E2 : SERIAL_7E1;
+		}
+		return 0;
+	}
+
+	uint16_t currentCoilMask() const
+	{
+		uint16_t mask = 0;
+		for(const auto& coil: _coils)
+		{
+			if(coil.CoilValue)
+				mask |= 1 << (coil.CoilAddress - COIL_BANK_START_ADDR);
+		}
+		return mask;
+	}
+
+	// Callers hold targetMutex
+	Modbus::Error writeCoilBank(uint8_t serverID, uint16_t mask)
+	{
+		uint8_t coilBytes[COIL_BANK_BYTES];
+		for(uint8_t i = 0; i < COIL_BANK_BYTES; ++i)
+		{
+			coilBytes[i] = static_cast<uint8_t>(mask >> (8 * i));
+		}
+
+		// Fresh token so a late echo of an older batch is not mistaken for this one
+		_coilBankWrite.slave_id = serverID;
+		_coilBankWrite.token = generateUniqueToken();
+		_coilBankWrite.value = mask;
+		_coilBankRead.slave_id = serverID;
+
+		ModbusMessage write_request;
+		Modbus::Error modbusError =
+			write_request.setMessage(serverID, _coilBankWrite.function_code,
+									 _coilBankWrite.start_address, _coilBankWrite.length,
+									 COIL_BANK_BYTES, coilBytes);
+		if(modbusError != Modbus::SUCCESS)
+		{
+			return modbusError;
+		}
+
+		// Track before queueing so a fast echo cannot overtake its own deadline entry
+		const uint16_t bankMask = (1 << MAX_COILS) - 1;
+		postConfirmEvent(ConfirmEventType::ISSUED, _coilBankWrite.token, bankMask, mask);
+
+		modbusError = submitRequest(_coilBankWrite, write_request);
+		if(modbusError != Modbus::SUCCESS)
+		{
+			postConfirmEvent(ConfirmEventType::CANCELLED, _coilBankWrite.token, bankMask, mask);
+			return modbusError;
+		}
+		_lastCoilBankMask = mask;
+
+		// Keep the single-coil write cache coherent with what the bank write just sent
+		for(auto& target: _targets)
+		{
+			if(target.type == TargetType::SWITCH_CONTROL && target.slave_id == serverID &&
+			   target.start_address >= COIL_BANK_START_ADDR &&
+			   target.start_address < COIL_BANK_START_ADDR + MAX_COILS)
+			{
+				bool on = (mask >> (target.start_address - COIL_BANK_START_ADDR)) & 0x01;
+				target.last_written_value = on ? 0xFF00 : 0x0000;
+			}
+		}
+		return Modbus::SUCCESS;
 	}
 
 	Modbus::Error setCoil(uint8_t serverID, uint16_t address, bool value)
 	{
 		uint16_t new_value = static_cast<uint16_t>(value ? 0xFF00 : 0x0000);
+		uint32_t token = 0;
+		uint8_t statsSlot = ModbusStats::NO_SLOT;
+		ModbusTransport transport = ModbusTransport::TCP;
 
 		// Check if the value is already set to avoid unnecessary Modbus writes
+		xSemaphoreTakeRecursive(targetMutex, portMAX_DELAY);
 		for(auto& target: _targets)
 		{
-			if(target.start_address == address && target.slave_id == serverID)
+			if(target.type == TargetType::SWITCH_CONTROL && target.start_address == address &&
+			   target.slave_id == serverID)
 			{
 				if(target.last_written_value == new_value)
 				{
 					// No need to write, the value hasn't changed
+					xSemaphoreGiveRecursive(targetMutex);
 					return Modbus::SUCCESS;
 				}
 				target.last_written_value = new_value; // Update last written value
+				// The bank no longer matches the last mask written; let the next batch through
+				_lastCoilBankMask = COIL_MASK_UNKNOWN;
+				token = target.token; // Echo is routed back through this target
+				transport = target.transport;
+				statsSlot = target.stats_slot;
 				break;
 			}
 		}
+		xSemaphoreGiveRecursive(targetMutex);
 
 		Target target_write = {TargetType::SWITCH_CONTROL,
 							   pzemServerIP,
 							   serverID,
 							   Modbus::FunctionCode::WRITE_COIL,
 							   address,
-							   generateUniqueToken(),
+							   token != 0 ? token : generateUniqueToken(),
 							   1,
 							   new_value};
-
-		Modbus::Error modbusError = Modbus::Error::UNDEFINED_ERROR;
+		target_write.transport = transport;
+		target_write.stats_slot = statsSlot;
+		target_write.priority = RequestPriority::CONTROL;
+
+		uint16_t coilBit = 1 << (address - COIL_BANK_START_ADDR);
+		postConfirmEvent(ConfirmEventType::ISSUED, target_write.token, coilBit,
+						 value ? coilBit : 0);
+
+		// Cached frame for the node's own coil server, else encoded once for all attempts
+		Modbus::Error modbusError = Modbus::SUCCESS;
+		ModbusMessage encoded;
+		const ModbusMessage* write_request = cachedCoilFrame(serverID, address, value);
+		if(write_request == nullptr)
+		{
+			_planStats.framesEncoded++;
+			modbusError = encoded.setMessage(target_write.slave_id, target_write.function_code,
+											 target_write.start_address, target_write.value);
+			write_request = &encoded;
+		}
 
 		// Retry logic for Modbus request
-		for(int attempt = 0; attempt < MAX_RETRIES; ++attempt)
+		const bool frameReady = modbusError == Modbus::SUCCESS;
+		for(int attempt = 0; frameReady && attempt < MAX_RETRIES; ++attempt)
 		{
-			// Create a new Modbus message for each attempt
-			ModbusMessage write_request;
-			modbusError =
-				write_request.setMessage(target_write.slave_id, target_write.function_code,
-										 target_write.start_address, target_write.value);
-
-			if(modbusError != Modbus::SUCCESS)
-			{
-				// Log this error if necessary
-				continue; // Retry the message creation
-			}
-
-			// Send the request using MBClient->addRequest
-			modbusError = MBClient->addRequest(write_request, target_write.token);
+			// Send the request on the coil target's transport
+			modbusError = submitRequest(target_write, *write_request);
+			_planStats.framesReused++;
 
 			if(modbusError == Modbus::SUCCESS)
 			{
@@ -592,72 +1923,59 @@ class ModbusManager
 			vTaskDelay(pdMS_TO_TICKS(100));
 		}
 
+		postConfirmEvent(ConfirmEventType::CANCELLED, target_write.token, coilBit, 0);
 		return modbusError; // Return the last error after all retries failed
 	}
-	Modbus::Error readCoil(uint8_t serverID, uint16_t address)
-	{
-		Target target_read = {TargetType::COIL_READ,		   pzemServerIP, serverID,
-							  Modbus::FunctionCode::READ_COIL, address,		 generateUniqueToken()};
-		addTarget(target_read);
-		Modbus::Error modbusError = Modbus::Error::UNDEFINED_ERROR;
-
-		// Retry logic for Modbus request
-		for(int attempt = 0; attempt < MAX_RETRIES; ++attempt)
-		{
-			// Create a new Modbus message for each attempt
-			ModbusMessage read_request;
-			modbusError = read_request.setMessage(target_read.slave_id, target_read.function_code,
-												  target_read.start_address, target_read.value);
-
-			if(modbusError != Modbus::SUCCESS)
-			{
-				// Log this error if necessary
-				continue; // Retry the message creation
-			}
-
-			// Send the request using MBClient->addRequest
-			modbusError = MBClient->addRequest(read_request, target_read.token);
-
-			if(modbusError == Modbus::SUCCESS)
-			{
-				return Modbus::SUCCESS; // Successful request, no further retries needed
-			}
 
-			// Small delay before retry (adjust if needed)
-			vTaskDelay(pdMS_TO_TICKS(100));
-		}
-		return modbusError;
+	const ModbusMessage* cachedCoilFrame(uint8_t serverID, uint16_t address, bool value) const
+	{
+		if(serverID != coilserver_id || address < COIL_BANK_START_ADDR ||
+		   address >= COIL_BANK_START_ADDR + MAX_COILS)
+			return nullptr;
+		const ModbusMessage& frame = _coilFrames[address - COIL_BANK_START_ADDR][value ? 1 : 0];
+		return frame.size() != 0 ? &frame : nullptr;
 	}
 
-	// Helper method to validate and process power data
-	bool validateAndProcessPowerData(ModbusMessage& response, OutBox* outbox)
+	// Register payload of a read reply, still in wire byte order; nullptr if too short
+	const uint16_t* registerWords(const ModbusMessage& response, size_t& count) const
 	{
-		if(!validateExtractPowerData(response, outbox))
+		if(response.size() < 20)
 		{
-			return false;
+			return nullptr;
 		}
+		count = (response.size() - 3) / 2;
+		return reinterpret_cast<const uint16_t*>(response.data() + 3);
+	}
 
-		// Update power measure based on processed data
-		if(outbox->type == MeasureType::INPUT_POWER)
-		{
-		}
-		else if(outbox->type == MeasureType::OUTPUT_POWER)
+	// Parse one meter's registers; wire is the request that carried them
+	void processPowerWords(const Target& target, const Target& wire, const uint16_t* words,
+						   size_t count)
+	{
+		if(!_meters.contains(target.meter_id))
 		{
+			Serial.printf("No meter %u registered for token %08X\n", target.meter_id,
+						  target.token);
+			return;
 		}
-
-		return true;
-	}
-	bool validateExtractPowerData(ModbusMessage& response, OutBox* outbox)
-	{
-		if(response.size() < 20)
+		// Parsed and corrected off to the side; readers only ever see the published copy
+		OutBox reading;
+		if(!parseOutBox(words, count, &reading))
 		{
-			Serial.println("Response size is insufficient for parsing.");
-			return false;
+			Serial.printf("Failed to process data for meter %u.\n", target.meter_id);
+			return;
 		}
-		const uint16_t* message = reinterpret_cast<const uint16_t*>(response.data() + 3);
-		size_t messageLength = (response.size() - 3) / 2;
-
-		return parseOutBox(message, messageLength, outbox);
+		xSemaphoreTake(meterMutex, portMAX_DELAY);
+		_meters.publish(target.meter_id, reading);
+		OutBox input = _meters.aggregate(MeterRole::INPUT);
+		OutBox output = _meters.aggregate(MeterRole::OUTPUT);
+		xSemaphoreGive(meterMutex);
+
+		recordPowerSample(target, wire, input, output);
+		ModbusStatusServer::getInstance().publishPower(input, output);
+
+		TaskHandle_t listener = _snapshotListener.load();
+		if(listener != nullptr)
+			xTaskNotify(listener, _snapshotBits.load(), eSetBits);
 	}
 	uint16_t toHostEndian16(uint16_t value)
 	{
@@ -742,7 +2060,45 @@ class ModbusManager
 			return;
 
 		// Update coils based on the extracted address and value(s)
-		updateCoils(response, startCoilAddress, numberOfCoils);
+		updateCoils(response, target, startCoilAddress, numberOfCoils);
+		postConfirmEvent(ConfirmEventType::OBSERVED, target.token, 0, currentCoilMask());
+	}
+
+	// FC 0x01 reply: [id][fc][byte count][coil bytes...], LSB of the first byte is start_address
+	void processCoilReadResponse(ModbusMessage& response, Target& target)
+	{
+		if(response.getFunctionCode() != 0x01 || response.size() < 3)
+		{
+			Serial.printf("Unexpected function code %02X for COIL_READ\n",
+						  response.getFunctionCode());
+			return;
+		}
+
+		uint8_t byteCount = response[2];
+		if(byteCount < (target.length + 7) / 8 || response.size() < 3 + byteCount ||
+		   target.length > MAX_COILS)
+		{
+			Serial.println("Invalid Read Coils response size.");
+			return;
+		}
+
+		uint16_t readMask = 0;
+		for(uint16_t i = 0; i < target.length; ++i)
+		{
+			if(response[3 + (i / 8)] & (1 << (i % 8)))
+				readMask |= 1 << i;
+		}
+
+		for(auto& coil: _coils)
+		{
+			if(coil.CoilAddress >= target.start_address &&
+			   coil.CoilAddress < target.start_address + target.length)
+			{
+				coil.CoilValue = (readMask >> (coil.CoilAddress - target.start_address)) & 0x01;
+			}
+		}
+
+		postConfirmEvent(ConfirmEventType::OBSERVED, target.token, 0, currentCoilMask(), true);
 	}
 	bool validateExtractCoilData(ModbusMessage& response, uint16_t& startCoilAddress,
 								 uint16_t& numberOfCoils)
@@ -785,13 +2141,14 @@ class ModbusManager
 	}
 
 	// Update the status of coils in the response
-	void updateCoils(ModbusMessage& response, uint16_t startCoilAddress, uint16_t numberOfCoils)
+	void updateCoils(ModbusMessage& response, const Target& target, uint16_t startCoilAddress,
+					 uint16_t numberOfCoils)
 	{
 		// Iterate through the coils and update their status
 		for(uint16_t i = 0; i < numberOfCoils; ++i)
 		{
 			uint16_t coilAddress = startCoilAddress + i;
-			bool isCoilOn = getCoilValue(response, i);
+			bool isCoilOn = getCoilValue(response, target, i);
 
 			// Find and update the corresponding coil
 			auto coilIt = std::find_if(_coils.begin(), _coils.end(), [&](const TesterCoil& coil) {
@@ -801,9 +2158,12 @@ class ModbusManager
 			if(coilIt != _coils.end())
 			{
 				coilIt->CoilValue = isCoilOn;
-				Serial.printf("Updated %s (Address=0x%04X) to %s\n",
-							  getCoilTypeName(coilIt->type).c_str(), coilAddress,
-							  isCoilOn ? "ON" : "OFF");
+				if(MODBUS_DEBUG)
+				{
+					Serial.printf("Updated %s (Address=0x%04X) to %s\n",
+								  getCoilTypeName(coilIt->type).c_str(), coilAddress,
+								  isCoilOn ? "ON" : "OFF");
+				}
 			}
 			else
 			{
@@ -813,7 +2173,7 @@ class ModbusManager
 	}
 
 	// Extract the coil value for a specific index in the response
-	bool getCoilValue(ModbusMessage& response, uint16_t index)
+	bool getCoilValue(ModbusMessage& response, const Target& target, uint16_t index)
 	{
 		if(updateSingleCoil)
 		{
@@ -821,7 +2181,8 @@ class ModbusManager
 		}
 		else
 		{
-			return (response[6 + (index / 8)] & (1 << (index % 8))) != 0; // Write Multiple Coils
+			// The FC 0x0F echo carries only address and quantity; values come from the request
+			return ((target.value >> index) & 0x01) != 0; // Write Multiple Coils
 		}
 	}
 	std::string getCoilTypeName(CoilType type)
@@ -0,0 +1,215 @@
+#ifndef POWER_SAMPLING_HPP
+#define POWER_SAMPLING_HPP
+
+#include <cmath>
+#include <cstdint>
+
+namespace Node_Utility
+{
+// One power reading and the moment it was taken, estimated as the middle of the round trip
+struct PowerSample
+{
+	float power = 0;
+	uint32_t at_us = 0;
+	bool valid = false;
+};
+
+struct AlignedPair
+{
+	float input = 0;
+	float output = 0;
+	uint32_t at_us = 0;
+	uint32_t skew_us = 0; // Distance between the two raw readings
+	bool interpolated = false;
+};
+
+struct EfficiencySnapshot
+{
+	uint32_t count = 0;
+	float mean = 0;
+	float stddev = 0;
+	float ci95 = 0;
+	uint32_t paired = 0;
+	uint32_t rejected = 0;
+	AlignedPair lastPair;
+};
+
+// Running efficiency (output / input) with Welford's mean and variance and a two-sided 95%
+// confidence interval on the mean, Student t for small samples.
+class EfficiencyEstimator
+{
+  public:
+	static constexpr float MIN_INPUT_W = 5.0f; // Below this the ratio is noise
+
+	bool add(const AlignedPair& pair)
+	{
+		if(pair.input < MIN_INPUT_W)
+			return false;
+
+		double ratio = pair.output / pair.input;
+		_count++;
+		double delta = ratio - _mean;
+		_mean += delta / _count;
+		_m2 += delta * (ratio - _mean);
+		return true;
+	}
+
+	void reset()
+	{
+		_count = 0;
+		_mean = 0;
+		_m2 = 0;
+	}
+
+	uint32_t count() const
+	{
+		return _count;
+	}
+	float mean() const
+	{
+		return static_cast<float>(_mean);
+	}
+	float stddev() const
+	{
+		return _count > 1 ? static_cast<float>(std::sqrt(_m2 / (_count - 1))) : 0.0f;
+	}
+	// Half-width of the interval, so the estimate is mean() +/- ci95()
+	float ci95() const
+	{
+		if(_count < 2)
+			return 0.0f;
+		return tCritical95(_count - 1) * stddev() / static_cast<float>(std::sqrt(_count));
+	}
+
+  private:
+	uint32_t _count = 0;
+	double _mean = 0;
+	double _m2 = 0;
+
+	static float tCritical95(uint32_t dof)
+	{
+		static const float table[] = {12.706f, 4.303f, 3.182f, 2.776f, 2.571f, 2.447f,
+									  2.365f,  2.306f, 2.262f, 2.228f, 2.201f, 2.179f,
+									  2.160f,  2.145f, 2.131f, 2.120f, 2.110f, 2.101f,
+									  2.093f,  2.086f, 2.080f, 2.074f, 2.069f, 2.064f,
+									  2.060f,  2.056f, 2.052f, 2.048f, 2.045f, 2.042f};
+		if(dof == 0)
+			return 0.0f;
+		return dof <= 30 ? table[dof - 1] : 1.960f;
+	}
+};
+
+// Turns independent input and output readings into pairs on a common timestamp. The pair is
+// placed at the earlier of the two newest readings; the other side is linearly interpolated
+// between its previous and newest reading when they straddle that moment, otherwise its
+// newest reading is used as long as the two are within MAX_SKEW_US of each other.
+class PairedSampler
+{
+  public:
+	static constexpr uint32_t MAX_SKEW_US = 300000;
+
+	// Returns true and fills pair once both sides have a reading newer than the last pair
+	bool addInput(float power, uint32_t at_us, AlignedPair& pair)
+	{
+		push(_input, power, at_us);
+		return tryPair(pair);
+	}
+	bool addOutput(float power, uint32_t at_us, AlignedPair& pair)
+	{
+		push(_output, power, at_us);
+		return tryPair(pair);
+	}
+
+	void reset()
+	{
+		_input = Side();
+		_output = Side();
+	}
+
+	uint32_t paired() const
+	{
+		return _paired;
+	}
+	uint32_t rejected() const
+	{
+		return _rejected;
+	}
+
+  private:
+	struct Side
+	{
+		PowerSample previous;
+		PowerSample latest;
+		bool fresh = false;
+	};
+
+	Side _input;
+	Side _output;
+	uint32_t _paired = 0;
+	uint32_t _rejected = 0;
+
+	static void push(Side& side, float power, uint32_t at_us)
+	{
+		side.previous = side.latest;
+		side.latest.power = power;
+		side.latest.at_us = at_us;
+		side.latest.valid = true;
+		side.fresh = true;
+	}
+
+	// Value of side at t, interpolated when t falls between its two readings
+	static float valueAt(const Side& side, uint32_t t, bool& interpolated)
+	{
+		interpolated = false;
+		if(!side.previous.valid)
+			return side.latest.power;
+
+		int32_t span = static_cast<int32_t>(side.latest.at_us - side.previous.at_us);
+		int32_t offset = static_cast<int32_t>(t - side.previous.at_us);
+		if(span <= 0 || offset < 0 || offset > span)
+			return side.latest.power;
+
+		interpolated = true;
+		float fraction = static_cast<float>(offset) / span;
+		return side.previous.power + fraction * (side.latest.power - side.previous.power);
+	}
+
+	bool tryPair(AlignedPair& pair)
+	{
+		if(!_input.fresh || !_output.fresh)
+			return false;
+		_input.fresh = false;
+		_output.fresh = false;
+
+		int32_t skew = static_cast<int32_t>(_output.latest.at_us - _input.latest.at_us);
+		pair.skew_us = static_cast<uint32_t>(skew < 0 ? -skew : skew);
+
+		bool interpolated = false;
+		if(skew >= 0)
+		{
+			// Input was read first; bring output back to the input's moment
+			pair.at_us = _input.latest.at_us;
+			pair.input = _input.latest.power;
+			pair.output = valueAt(_output, pair.at_us, interpolated);
+		}
+		else
+		{
+			pair.at_us = _output.latest.at_us;
+			pair.output = _output.latest.power;
+			pair.input = valueAt(_input, pair.at_us, interpolated);
+		}
+		pair.interpolated = interpolated;
+
+		if(!interpolated && pair.skew_us > MAX_SKEW_US)
+		{
+			_rejected++;
+			return false;
+		}
+		_paired++;
+		return true;
+	}
+};
+
+} // namespace Node_Utility
+
+#endif // POWER_SAMPLING_HPP
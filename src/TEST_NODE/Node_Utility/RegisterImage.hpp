@@ -0,0 +1,84 @@
+#ifndef REGISTER_IMAGE_HPP
+#define REGISTER_IMAGE_HPP
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+namespace Node_Utility
+{
+// Double-buffered register image for one writer and any number of readers. The writer fills
+// the back buffer and flips the front index; each buffer carries a sequence number that is odd
+// while it is being written, so a reader that raced a second flip notices and copies again.
+// Readers never take a lock and never block the writer.
+template<size_t WORDS>
+class RegisterImage
+{
+  public:
+	static constexpr size_t SIZE = WORDS;
+	static constexpr uint8_t READ_RETRIES = 4;
+
+	// Writer side; callers serialise publish() among themselves
+	void publish(const std::array<uint16_t, WORDS>& words)
+	{
+		uint8_t back = _front.load(std::memory_order_relaxed) ^ 1;
+		Buffer& buffer = _buffers[back];
+
+		buffer.seq.fetch_add(1, std::memory_order_relaxed);
+		std::atomic_thread_fence(std::memory_order_release);
+		buffer.words = words;
+		buffer.seq.fetch_add(1, std::memory_order_release);
+
+		_front.store(back, std::memory_order_release);
+		_publishes.fetch_add(1, std::memory_order_relaxed);
+	}
+
+	// Copies count words from address; false on a bad range or after READ_RETRIES torn reads
+	bool read(size_t address, size_t count, uint16_t* out) const
+	{
+		if(count == 0 || address >= WORDS || count > WORDS - address)
+			return false;
+
+		for(uint8_t attempt = 0; attempt < READ_RETRIES; ++attempt)
+		{
+			const Buffer& buffer = _buffers[_front.load(std::memory_order_acquire)];
+			uint32_t before = buffer.seq.load(std::memory_order_acquire);
+			if(before & 1)
+				continue;
+
+			memcpy(out, &buffer.words[address], count * sizeof(uint16_t));
+			std::atomic_thread_fence(std::memory_order_acquire);
+			if(buffer.seq.load(std::memory_order_relaxed) == before)
+				return true;
+		}
+		_tornReads.fetch_add(1, std::memory_order_relaxed);
+		return false;
+	}
+
+	uint32_t publishes() const
+	{
+		return _publishes.load(std::memory_order_relaxed);
+	}
+	uint32_t tornReads() const
+	{
+		return _tornReads.load(std::memory_order_relaxed);
+	}
+
+  private:
+	struct Buffer
+	{
+		std::atomic<uint32_t> seq{0};
+		std::array<uint16_t, WORDS> words{};
+	};
+
+	Buffer _buffers[2];
+	std::atomic<uint8_t> _front{0};
+	std::atomic<uint32_t> _publishes{0};
+	mutable std::atomic<uint32_t> _tornReads{0};
+};
+
+} // namespace Node_Utility
+
+#endif // REGISTER_IMAGE_HPP
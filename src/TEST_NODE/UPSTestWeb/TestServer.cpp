@@ -3,9 +3,11 @@
 #include <map>
 #include <Ticker.h>
 #include "HPTSettings.h"
+#include "PZEM_Modbus.hpp"
 
 Ticker pingTimer;
 extern TaskHandle_t PeriodicDataHandle;
+extern Node_Utility::ModbusManager& MBManager;
 // Other includes as necessary
 
 #define ETAG "\"" __DATE__ " " __TIME__ "\""
@@ -23,6 +25,12 @@ void TestServer::servePages(UPSTesterSetup& _setup, TestSync& _sync)
 	_server->on("/log", HTTP_GET, [this](AsyncWebServerRequest* request) {
 		this->handleLogRequest(request);
 	});
+	_server->on("/modbus/stats", HTTP_GET, [this](AsyncWebServerRequest* request) {
+		this->handleModbusStatsRequest(request);
+	});
+	_server->on("/ws/stats", HTTP_GET, [this](AsyncWebServerRequest* request) {
+		this->handleWsStatsRequest(request);
+	});
 
 	_server->on("/settings/ups-specification", HTTP_GET,
 				[this, &_setup](AsyncWebServerRequest* request) {
@@ -93,6 +101,213 @@ void TestServer::handleLogRequest(AsyncWebServerRequest* request)
 	String logs = logger.getBufferedLogs();
 	request->send(200, "text/plain", logs.length() > 0 ? logs : "No logs available.");
 }
+void TestServer::handleModbusStatsRequest(AsyncWebServerRequest* request)
+{
+	using Node_Utility::ModbusStats;
+	using Node_Utility::RttHistogram;
+
+	const ModbusStats& stats = MBManager.getStats();
+	JsonDocument doc;
+
+	doc["pollProfile"] = MBManager.getPollProfile().name;
+	doc["queueDepth"] = MBManager.pendingRequests();
+	doc["maxQueueDepth"] = stats.maxQueueDepth();
+
+	const auto& pool = MBManager.getTcpPoolStats();
+	JsonObject tcp = doc["tcpPool"].to<JsonObject>();
+	tcp["opened"] = pool.opened;
+	tcp["evicted"] = pool.evicted;
+	tcp["connects"] = pool.connects;
+	tcp["drops"] = pool.drops;
+	tcp["connectFailures"] = pool.connectFailures;
+	tcp["deferred"] = pool.deferred;
+
+	const auto& plan = MBManager.getPollPlanStats();
+	JsonObject planJson = doc["pollPlan"].to<JsonObject>();
+	planJson["blocks"] = plan.blocks;
+	planJson["targets"] = plan.targets;
+	planJson["framesEncoded"] = plan.framesEncoded;
+	planJson["framesReused"] = plan.framesReused;
+
+	const auto& cache = MBManager.getReadCacheStats();
+	JsonObject cacheJson = doc["readCache"].to<JsonObject>();
+	cacheJson["hits"] = cache.hits;
+	cacheJson["joins"] = cache.joins;
+	cacheJson["misses"] = cache.misses;
+	cacheJson["evictions"] = cache.evictions;
+	cacheJson["expired"] = cache.expired;
+
+	const auto& coils = MBManager.getCoilConfirmStats();
+	JsonObject coil = doc["coilConfirm"].to<JsonObject>();
+	coil["confirmed"] = coils.confirmed;
+	coil["failed"] = coils.failed;
+	coil["readbacks"] = coils.readbacks;
+	coil["lastUs"] = coils.last_us;
+	coil["maxUs"] = coils.max_us;
+
+	auto& statusServer = Node_Utility::ModbusStatusServer::getInstance();
+	JsonObject plc = doc["statusServer"].to<JsonObject>();
+	plc["running"] = statusServer.isRunning();
+	plc["clients"] = statusServer.activeClients();
+	plc["reads"] = statusServer.reads();
+	plc["refused"] = statusServer.refused();
+	plc["publishes"] = statusServer.image().publishes();
+	plc["tornReads"] = statusServer.image().tornReads();
+
+	Node_Utility::EfficiencySnapshot efficiency = MBManager.getEfficiency();
+	JsonObject eff = doc["efficiency"].to<JsonObject>();
+	eff["samples"] = efficiency.count;
+	eff["mean"] = efficiency.mean;
+	eff["stddev"] = efficiency.stddev;
+	eff["ci95"] = efficiency.ci95;
+	eff["paired"] = efficiency.paired;
+	eff["rejected"] = efficiency.rejected;
+	eff["lastSkewUs"] = efficiency.lastPair.skew_us;
+
+	static const char* const classNames[] = {"control", "testCritical", "dashboard"};
+	JsonObject classes = doc["classes"].to<JsonObject>();
+	for(size_t c = 0; c < Node_Utility::PRIORITY_CLASSES; ++c)
+	{
+		auto priority = static_cast<Node_Utility::RequestPriority>(c);
+		const auto& cls = MBManager.getClassStats(priority);
+		JsonObject entry = classes[classNames[c]].to<JsonObject>();
+		entry["queued"] = MBManager.getQueuedRequests(priority);
+		entry["enqueued"] = cls.enqueued;
+		entry["coalesced"] = cls.coalesced;
+		entry["dropped"] = cls.dropped;
+		entry["dispatched"] = cls.dispatched;
+		entry["completed"] = cls.completed;
+		entry["waitP50Ms"] = cls.wait.percentileMs(0.50f);
+		entry["waitP99Ms"] = cls.wait.percentileMs(0.99f);
+		entry["latencyP50Ms"] = cls.latency.percentileMs(0.50f);
+		entry["latencyP99Ms"] = cls.latency.percentileMs(0.99f);
+		entry["latencyMaxUs"] = cls.latency.maxUs();
+	}
+
+	JsonArray targets = doc["targets"].to<JsonArray>();
+	for(size_t i = 0; i < stats.size(); ++i)
+	{
+		const Node_Utility::ModbusTargetStats& t = stats.at(i);
+		JsonObject entry = targets.add<JsonObject>();
+		entry["ip"] = t.ip.toString();
+		entry["slave"] = t.slave_id;
+		entry["fc"] = t.function_code;
+		entry["address"] = t.start_address;
+		entry["type"] = t.type;
+		entry["requests"] = t.requests;
+		entry["rejected"] = t.rejected;
+		entry["responses"] = t.responses;
+		entry["timeouts"] = t.timeouts;
+		entry["exceptions"] = t.exceptions;
+		entry["errors"] = t.errors;
+		entry["lastError"] = t.lastError;
+		entry["lastRttUs"] = t.lastRtt_us;
+		entry["maxRttUs"] = t.rtt.maxUs();
+		entry["p50Ms"] = t.rtt.percentileMs(0.50f);
+		entry["p90Ms"] = t.rtt.percentileMs(0.90f);
+		entry["p99Ms"] = t.rtt.percentileMs(0.99f);
+		entry["lastSuccessAgeMs"] = ModbusStats::successAgeMs(t);
+
+		const Node_Utility::TargetHealth* health = MBManager.getHealth(i);
+		if(health != nullptr)
+		{
+			entry["srttUs"] = health->rtt.srttUs();
+			entry["rttvarUs"] = health->rtt.rttvarUs();
+			entry["rtoMs"] = health->rtt.rtoMs();
+			entry["breaker"] = static_cast<uint8_t>(health->breaker.state());
+			entry["breakerTrips"] = health->breaker.trips();
+		}
+
+		JsonArray buckets = entry["rttBuckets"].to<JsonArray>();
+		for(size_t b = 0; b < RttHistogram::BUCKETS; ++b)
+		{
+			buckets.add(t.rtt.bucket(b));
+		}
+	}
+
+	auto* response = request->beginResponseStream("application/json");
+	serializeJson(doc, *response);
+	request->send(response);
+}
+
+void TestServer::handleWsStatsRequest(AsyncWebServerRequest* request)
+{
+	DataHandler& dataHandler = DataHandler::getInstance();
+	JsonDocument doc;
+
+	static const char* const formatNames[] = {"json", "pb", "delta"};
+	JsonObject frames = doc["frames"].to<JsonObject>();
+	const FrameStats* encodings[] = {&dataHandler.jsonStats(), &dataHandler.binaryStats(),
+									 &dataHandler.deltaStats()};
+	for(size_t f = 0; f < sizeof(encodings) / sizeof(encodings[0]); ++f)
+	{
+		const FrameStats& stats = *encodings[f];
+		JsonObject entry = frames[formatNames[f]].to<JsonObject>();
+		entry["frames"] = stats.frames;
+		entry["lastBytes"] = stats.lastBytes;
+		entry["lastEncodeUs"] = stats.lastEncode_us;
+		entry["totalBytes"] = stats.totalBytes;
+		entry["totalEncodeUs"] = stats.totalEncode_us;
+	}
+
+	// Readings fan-out per transport, to weigh a read-only viewer on /events against one on /ws.
+	// The client object is the transport's fixed cost; queued frames add to it.
+	JsonObject fanout = doc["fanout"].to<JsonObject>();
+	const FrameStats* transports[] = {&dataHandler.wsFanoutStats(),
+									  &dataHandler.sseFanoutStats()};
+	static const char* const transportNames[] = {"ws", "sse"};
+	const size_t clientBytes[] = {sizeof(AsyncWebSocketClient) + sizeof(PushState),
+								  sizeof(AsyncEventSourceClient)};
+	for(size_t t = 0; t < sizeof(transports) / sizeof(transports[0]); ++t)
+	{
+		const FrameStats& stats = *transports[t];
+		JsonObject entry = fanout[transportNames[t]].to<JsonObject>();
+		entry["frames"] = stats.frames;
+		entry["lastBytes"] = stats.lastBytes;
+		entry["lastFanoutUs"] = stats.lastEncode_us;
+		entry["totalBytes"] = stats.totalBytes;
+		entry["totalFanoutUs"] = stats.totalEncode_us;
+		entry["clientObjectBytes"] = clientBytes[t];
+	}
+	fanout["ws"]["clients"] = _ws->count();
+	fanout["sse"]["clients"] = _events->count();
+	fanout["sse"]["avgQueued"] = _events->avgPacketsWaiting();
+
+	const CommandStats commands = dataHandler.commandStats();
+	JsonObject cmd = doc["commands"].to<JsonObject>();
+	cmd["budgetMs"] = COMMAND_LATENCY_BUDGET_MS;
+	cmd["accepted"] = commands.accepted;
+	cmd["rejected"] = commands.rejected;
+	cmd["completed"] = commands.completed;
+	cmd["overBudget"] = commands.overBudget;
+	cmd["lastDispatchUs"] = commands.lastDispatch_us;
+	cmd["lastTotalUs"] = commands.lastTotal_us;
+	cmd["dispatchP50Ms"] = commands.dispatch.percentileMs(0.50f);
+	cmd["dispatchP99Ms"] = commands.dispatch.percentileMs(0.99f);
+	cmd["dispatchMaxUs"] = commands.dispatch.maxUs();
+	cmd["totalP50Ms"] = commands.total.percentileMs(0.50f);
+	cmd["totalP99Ms"] = commands.total.percentileMs(0.99f);
+	cmd["totalMaxUs"] = commands.total.maxUs();
+
+	JsonArray clients = doc["clients"].to<JsonArray>();
+	for(const ClientQueueStats& stats: dataHandler.clientStats())
+	{
+		JsonObject entry = clients.add<JsonObject>();
+		entry["id"] = stats.clientId;
+		entry["format"] = formatNames[static_cast<size_t>(stats.format)];
+		entry["slow"] = stats.slow;
+		entry["sent"] = stats.sent;
+		entry["dropped"] = stats.dropped;
+		entry["downgrades"] = stats.downgrades;
+		entry["queueLen"] = stats.queueLen;
+		entry["queuePeak"] = stats.queuePeak;
+	}
+
+	auto* response = request->beginResponseStream("application/json");
+	serializeJson(doc, *response);
+	request->send(response);
+}
+
 void TestServer::handleSettingRequest(AsyncWebServerRequest* request, UPSTesterSetup& _setup,
 									  const char* caption, SettingType type,
 									  const char* redirect_uri)
@@ -305,6 +520,14 @@ void TestServer::initWebSocket()
 	_server->addHandler(_ws);
 }
 
+void TestServer::initEventSource()
+{
+	_events->onConnect([](AsyncEventSourceClient* client) {
+		DataHandler::getInstance().replaySse(client);
+	});
+	_server->addHandler(_events);
+}
+
 void TestServer::createServerTask()
 {
 	xTaskCreatePinnedToCore(wsClientCleanup, "WSCleanupTask", WSCleanup_Stack, _ws,
@@ -316,11 +539,14 @@ void TestServer::createWsDataHandlerTask()
 	// Initialize the member struct with necessary values
 	DataHandler& dataHandler = DataHandler::getInstance();
 	wsHandlerTaskParams.ws = _ws;
+	wsHandlerTaskParams.events = _events;
 
 	// Pass the pointer to the member struct
 	xTaskCreatePinnedToCore(dataHandler.wsDataHandler, "wsDataHandler", wsDataHandler_Stack,
 							&wsHandlerTaskParams, wsDataHandler_Priority,
 							&DataHandler::getInstance().dataTaskHandler, wsDataHandler_CORE);
+	// Readings are pushed as they arrive instead of waiting for the heartbeat
+	MBManager.setSnapshotListener(dataHandler.dataTaskHandler, READINGS_READY_NOTIFY);
 }
 
 void TestServer::wsClientCleanup(void* pvParameters)
@@ -374,6 +600,7 @@ void TestServer::onWsEvent(AsyncWebSocket* server, AsyncWebSocketClient* client,
 		case WS_EVT_DISCONNECT:
 			Serial.printf("WebSocket client #%u disconnected\n", client->id());
 			DataHandler::getInstance().updateClientList(client->id(), false);
+			_uploads.erase(client->id());
 			EventHelper::clearBits(wsClientStatus::CONNECTED);
 			EventHelper::setBits(wsClientStatus::DISCONNECTED);
 			EventHelper::clearBits(wsClientUpdate::GET_READING);
@@ -388,8 +615,15 @@ void TestServer::onWsEvent(AsyncWebSocket* server, AsyncWebSocketClient* client,
 		case WS_EVT_DATA:
 		{
 			AwsFrameInfo* info = static_cast<AwsFrameInfo*>(arg);
+			bool whole = info->final && info->index == 0 && info->len == len;
 
-			if(info->final && info->index == 0 && info->len == len && info->opcode == WS_TEXT)
+			// JSON and MessagePack bodies, and anything spread over several frames, are uploads
+			if(!whole || info->opcode != WS_TEXT ||
+			   (len > 0 && (data[0] == '[' || data[0] == '{')))
+			{
+				handleWsUpload(client, info, data, len);
+			}
+			else
 			{
 				if(len >= WS_BUFFER_SIZE)
 				{
@@ -398,12 +632,15 @@ void TestServer::onWsEvent(AsyncWebSocket* server, AsyncWebSocketClient* client,
 					return;
 				}
 
-				WebSocketMessage wsMsg = {};
-				memcpy(wsMsg.data, data, len);
-				wsMsg.len = len;
-				wsMsg.info = *info;
-				wsMsg.client_id = client->id();
-				wsMsg.client = client;
+				// User commands skip the data task and go straight to the command task; a history
+				// request only registers a catch-up for the data task to pace
+				const char* text = reinterpret_cast<const char*>(data);
+				DataHandler& dataHandler = DataHandler::getInstance();
+				if(dataHandler.dispatchCommand(client, text, len) ||
+				   dataHandler.requestHistory(client, text, len))
+				{
+					return;
+				}
 
 				if(xEventGroupWaitBits(EventHelper::wsClientEventGroup,
 									   static_cast<EventBits_t>(wsClientStatus::CONNECTED), pdFALSE,
@@ -411,23 +648,20 @@ void TestServer::onWsEvent(AsyncWebSocket* server, AsyncWebSocketClient* client,
 				{
 					EventHelper::setBits(wsClientStatus::DATA);
 
-					if(strcmp(reinterpret_cast<char*>(wsMsg.data), "getReadings") == 0)
+					const WsCommandName* command = findWsCommand(text, len);
+					bool getReadings =
+						command != nullptr && command->cmd == wsIncomingCommands::GET_READINGS;
+					if(dataHandler.postWsMessage(client, text, len))
 					{
-						if(xQueueSend(DataHandler::getInstance().WebsocketDataQueue, &wsMsg,
-									  QUEUE_TIMEOUT_MS) == pdTRUE)
+						if(getReadings)
 						{
 							EventHelper::setBits(wsClientUpdate::GET_READING);
 							client->text(R"({"SUCCESS":"Received Get Readings Command"})");
 						}
-						else
-						{
-							Serial.println("Queue full. Message dropped.");
-						}
 					}
-					else if(xQueueSend(DataHandler::getInstance().WebsocketDataQueue, &wsMsg,
-									   QUEUE_TIMEOUT_MS) != pdTRUE)
+					else
 					{
-						Serial.println("Failed to enqueue message.");
+						Serial.println("No free message slot or message too long. Dropped.");
 					}
 				}
 				else
@@ -435,10 +669,6 @@ void TestServer::onWsEvent(AsyncWebSocket* server, AsyncWebSocketClient* client,
 					client->text(R"({"error":"Connection timeout"})");
 				}
 			}
-			else
-			{
-				client->text(R"({"error":"Invalid WebSocket frame"})");
-			}
 			break;
 		}
 
@@ -452,6 +682,80 @@ void TestServer::onWsEvent(AsyncWebSocket* server, AsyncWebSocketClient* client,
 	}
 }
 
+static const char* uploadError(WsUpload::Status status)
+{
+	switch(status)
+	{
+		case WsUpload::Status::TOO_LARGE:
+			return "Upload too large";
+		case WsUpload::Status::NO_MEMORY:
+			return "Out of memory";
+		default:
+			return "Invalid upload";
+	}
+}
+
+// Frames of one message arrive in order on the async_tcp task. Each test of a plan is queued,
+// and each settings section applied, as soon as its closing bracket comes in.
+void TestServer::handleWsUpload(AsyncWebSocketClient* client, AwsFrameInfo* info, uint8_t* data,
+								size_t len)
+{
+	WsUpload& upload = _uploads[client->id()];
+	WsUpload::Status status = WsUpload::Status::OK;
+
+	if(info->num == 0 && info->index == 0)
+	{
+		status = upload.begin(info->message_opcode == WS_BINARY);
+	}
+	else if(!upload.active())
+	{
+		_uploads.erase(client->id()); // Rest of a message already refused
+		return;
+	}
+
+	bool last = info->final && info->index + len == info->len;
+	if(status == WsUpload::Status::OK)
+	{
+		status = upload.feed(data, len, last, [this](WsUpload::Kind kind, JsonVariant element) {
+			if(kind == WsUpload::Kind::PLAN)
+			{
+				_sync.parseIncomingJson(element);
+			}
+			else
+			{
+				_setup.applySettings(element);
+			}
+		});
+	}
+	if(status == WsUpload::Status::OK && !last)
+	{
+		return;
+	}
+
+	// Sections applied before a failure stay in effect, so they are saved either way
+	if(upload.kind() == WsUpload::Kind::SETTINGS && upload.elements() > 0)
+	{
+		_setup.commitSettings();
+	}
+
+	const char* kind = upload.kind() == WsUpload::Kind::SETTINGS ? "settings" : "plan";
+	char reply[WS_BUFFER_SIZE];
+	if(status == WsUpload::Status::OK)
+	{
+		snprintf(reply, sizeof(reply), R"({"type":"upload","kind":"%s","items":%u,"bytes":%u})",
+				 kind, upload.elements(), static_cast<unsigned>(upload.received()));
+	}
+	else
+	{
+		logger.log(LogLevel::WARNING, "Upload from client #%u refused: %s", client->id(),
+				   uploadError(status));
+		snprintf(reply, sizeof(reply), R"({"type":"upload","error":"%s","items":%u})",
+				 uploadError(status), upload.elements());
+	}
+	client->text(reply);
+	_uploads.erase(client->id());
+}
+
 // void TestServer::onWsEvent(AsyncWebSocket* server, AsyncWebSocketClient* client, AwsEventType
 // type, 						   void* arg, uint8_t* data, size_t len)
 // {
@@ -17,18 +17,21 @@
 #include "UPSTesterSetup.h"
 #include "Filehandler.h"
 #include <deque>
+#include <map>
 #include "DataHandler.h"
+#include "wsUpload.hpp"
 
 class TestServer
 {
   public:
-	TestServer(AsyncWebServer* server, AsyncWebSocket* ws, UPSTesterSetup& _setup,
-			   TestSync& _sync) :
+	TestServer(AsyncWebServer* server, AsyncWebSocket* ws, AsyncEventSource* events,
+			   UPSTesterSetup& _setup, TestSync& _sync) :
 		_server(server),
-		_ws(ws), webPage(new PageBuilder()), _setup(UPSTesterSetup::getInstance()),
-		_sync(TestSync::getInstance())
+		_ws(ws), _events(events), webPage(new PageBuilder()),
+		_setup(UPSTesterSetup::getInstance()), _sync(TestSync::getInstance())
 	{
 		initWebSocket();
+		initEventSource();
 		createServerTask();
 		createWsDataHandlerTask();
 	}
@@ -57,6 +60,7 @@ class TestServer
 	}
 
 	void initWebSocket();
+	void initEventSource();
 
 	void servePages(UPSTesterSetup& _setup, TestSync& _sync);
 	void createWsDataHandlerTask();
@@ -64,16 +68,21 @@ class TestServer
   private:
 	AsyncWebServer* _server;
 	AsyncWebSocket* _ws;
+	AsyncEventSource* _events;
 
 	PageBuilder* webPage;
 	Node_Utility::FileHandler _fileHandler;
 	UPSTesterSetup& _setup;
 	TestSync& _sync;
 	WsDataHandlerTaskParams wsHandlerTaskParams;
+	// Uploads in progress by client id; only the async_tcp task touches it
+	std::map<uint32_t, WsUpload> _uploads;
 
 	// HTTP_GET
 	void handleRootRequest(AsyncWebServerRequest* request);
 	void handleLogRequest(AsyncWebServerRequest* request);
+	void handleModbusStatsRequest(AsyncWebServerRequest* request);
+	void handleWsStatsRequest(AsyncWebServerRequest* request);
 	void handleDashboardRequest(AsyncWebServerRequest* request);
 	void handleSettingRequest(AsyncWebServerRequest* request, UPSTesterSetup& _setup,
 							  const char* caption, SettingType type, const char* redirect_uri);
@@ -92,6 +101,8 @@ class TestServer
 
 	void onWsEvent(AsyncWebSocket* server, AsyncWebSocketClient* client, AwsEventType type,
 				   void* arg, uint8_t* data, size_t len);
+	void handleWsUpload(AsyncWebSocketClient* client, AwsFrameInfo* info, uint8_t* data,
+						size_t len);
 	static void sendPing(AsyncWebSocketClient* client);
 	void createServerTask();
 	static void wsClientCleanup(void* pvParameters);
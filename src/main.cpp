@@ -75,6 +75,7 @@ const char* PARAM_MESSAGE = "message";
 SemaphoreHandle_t xSemaphore;
 AsyncWebServer server(80);
 AsyncWebSocket ws("/ws");
+AsyncEventSource events("/events");
 
 WiFiManager wm;
 // WiFiClient theClient;
@@ -221,13 +222,29 @@ void setup()
 	SyncTest.init();
 	logger.log(LogLevel::INFO, "initiating modbus");
 
-	// Issue a request
+	// Register the meters, then the targets that feed them
+
+	NamePlate inputMeter;
+	inputMeter.model = PZEMModel::PZEM004T;
+	inputMeter.id = 1;
+	inputMeter.slaveAddress = 1;
+	MBManager.registerMeter(inputMeter, MeterRole::INPUT);
+
+	NamePlate outputMeter;
+	outputMeter.model = PZEMModel::PZEM004T;
+	outputMeter.id = 2;
+	outputMeter.slaveAddress = 2;
+	MBManager.registerMeter(outputMeter, MeterRole::OUTPUT);
 
 	Node_Utility::ModbusManager::Target target1 = {
 		TargetType::INPUT_POWER, IPAddress(192, 168, 0, 172), 1, READ_HOLD_REGISTER, 761, 0, 21};
+	target1.meter_id = inputMeter.id;
 	Node_Utility::ModbusManager::Target target2 = {
 		TargetType::OUTPUT_POWER, IPAddress(192, 168, 0, 172), 2, READ_HOLD_REGISTER, 123, 0, 21};
+	target2.meter_id = outputMeter.id;
 
+	MBManager.setCalibration(TesterSetup.calibrationSetup());
+	MBManager.configureRTU(TesterSetup.modbusSetup()); // RS485 opens with the first RTU target
 	MBManager.autopoll(true, target1, target2);
 
 	logger.log(LogLevel::INFO, "modbus client configured");
@@ -251,12 +268,14 @@ void setup()
 	TesterSetup.addObserver(&Manager);
 	TesterSetup.addObserver(&switchTest);
 	TesterSetup.addObserver(&backupTest);
+	TesterSetup.addObserver(&MBManager);
 
-	TestServer testServer(&server, &ws, TesterSetup, SyncTest);
+	TestServer testServer(&server, &ws, &events, TesterSetup, SyncTest);
 	testServer.servePages(TesterSetup, SyncTest);
 	testServer.begin();
 
 	server.begin();
+	Node_Utility::ModbusStatusServer::getInstance().begin();
 	if(ws.enabled())
 	{
 		logger.log(LogLevel::SUCCESS, "Websocket is enabled");
@@ -0,0 +1,34 @@
+#ifndef HOST_ALLOCATION_COUNTER_H
+#define HOST_ALLOCATION_COUNTER_H
+
+// Counts calls to the global operator new. It replaces the allocator for the whole test
+// program, so include it from one translation unit only: the test's main file.
+#include <cstdlib>
+#include <new>
+
+inline long& hostAllocations()
+{
+	static long count = 0;
+	return count;
+}
+
+void* operator new(size_t size)
+{
+	hostAllocations()++;
+	void* p = malloc(size);
+	if(p == nullptr)
+		throw std::bad_alloc();
+	return p;
+}
+
+void operator delete(void* p) noexcept
+{
+	free(p);
+}
+
+void operator delete(void* p, size_t) noexcept
+{
+	free(p);
+}
+
+#endif // HOST_ALLOCATION_COUNTER_H
@@ -0,0 +1,32 @@
+#ifndef HOST_ARDUINO_H
+#define HOST_ARDUINO_H
+
+// Just enough of the Arduino core for the native tests. The clock only moves when a test
+// moves it, so timing-dependent code runs the same on every host.
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+inline uint32_t& hostClock_us()
+{
+	static uint32_t now_us = 0;
+	return now_us;
+}
+
+inline void hostAdvance_us(uint32_t us)
+{
+	hostClock_us() += us;
+}
+
+inline unsigned long micros()
+{
+	return hostClock_us();
+}
+
+inline unsigned long millis()
+{
+	return hostClock_us() / 1000;
+}
+
+#endif // HOST_ARDUINO_H
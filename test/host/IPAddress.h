@@ -0,0 +1,38 @@
+#ifndef HOST_IPADDRESS_H
+#define HOST_IPADDRESS_H
+
+#include <cstdint>
+#include <cstring>
+
+class IPAddress
+{
+  public:
+	IPAddress() = default;
+	IPAddress(uint8_t a, uint8_t b, uint8_t c, uint8_t d) : _bytes{a, b, c, d}
+	{
+	}
+
+	operator uint32_t() const
+	{
+		uint32_t value;
+		memcpy(&value, _bytes, sizeof(value));
+		return value;
+	}
+	bool operator==(const IPAddress& other) const
+	{
+		return memcmp(_bytes, other._bytes, sizeof(_bytes)) == 0;
+	}
+	bool operator!=(const IPAddress& other) const
+	{
+		return !(*this == other);
+	}
+	uint8_t operator[](int i) const
+	{
+		return _bytes[i];
+	}
+
+  private:
+	uint8_t _bytes[4] = {0, 0, 0, 0};
+};
+
+#endif // HOST_IPADDRESS_H
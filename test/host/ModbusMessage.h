@@ -0,0 +1,55 @@
+#ifndef HOST_MODBUS_MESSAGE_H
+#define HOST_MODBUS_MESSAGE_H
+
+// Vector-backed like eModbus's: setMessage clears the buffer and appends the PDU
+#include <cstdint>
+#include <vector>
+#include "ModbusTypeDefs.h"
+
+class ModbusMessage
+{
+  public:
+	Modbus::Error setMessage(uint8_t serverId, uint8_t functionCode, uint16_t p1, uint16_t p2)
+	{
+		_data.clear();
+		_data.reserve(6);
+		const uint8_t pdu[] = {serverId,
+							   functionCode,
+							   static_cast<uint8_t>(p1 >> 8),
+							   static_cast<uint8_t>(p1),
+							   static_cast<uint8_t>(p2 >> 8),
+							   static_cast<uint8_t>(p2)};
+		_data.insert(_data.end(), pdu, pdu + sizeof(pdu));
+		return Modbus::SUCCESS;
+	}
+
+	uint8_t getServerID() const
+	{
+		return _data.empty() ? 0 : _data[0];
+	}
+	uint8_t getFunctionCode() const
+	{
+		return _data.size() < 2 ? 0 : _data[1];
+	}
+	uint16_t size() const
+	{
+		return static_cast<uint16_t>(_data.size());
+	}
+	const uint8_t* data() const
+	{
+		return _data.data();
+	}
+	uint8_t operator[](uint16_t i) const
+	{
+		return _data[i];
+	}
+	bool operator==(const ModbusMessage& other) const
+	{
+		return _data == other._data;
+	}
+
+  private:
+	std::vector<uint8_t> _data;
+};
+
+#endif // HOST_MODBUS_MESSAGE_H
@@ -0,0 +1,39 @@
+#ifndef HOST_MODBUS_TYPEDEFS_H
+#define HOST_MODBUS_TYPEDEFS_H
+
+// eModbus's codes, with the values the library uses
+#include <cstdint>
+
+namespace Modbus
+{
+enum FunctionCode : uint8_t
+{
+	READ_COIL = 0x01,
+	READ_DISCR_INPUT = 0x02,
+	READ_HOLD_REGISTER = 0x03,
+	READ_INPUT_REGISTER = 0x04,
+	WRITE_COIL = 0x05,
+	WRITE_HOLD_REGISTER = 0x06,
+	WRITE_MULT_COILS = 0x0F,
+	WRITE_MULT_REGISTERS = 0x10
+};
+
+enum Error : uint8_t
+{
+	SUCCESS = 0x00,
+	ILLEGAL_FUNCTION = 0x01,
+	ILLEGAL_DATA_ADDRESS = 0x02,
+	ILLEGAL_DATA_VALUE = 0x03,
+	SERVER_DEVICE_FAILURE = 0x04,
+	SERVER_DEVICE_BUSY = 0x06,
+	GATEWAY_PATH_UNAVAIL = 0x0A,
+	GATEWAY_TARGET_NO_RESP = 0x0B,
+	TIMEOUT = 0xE0,
+	CRC_ERROR = 0xE2,
+	REQUEST_QUEUE_FULL = 0xE8,
+	IP_CONNECTION_FAILED = 0xEA,
+	UNDEFINED_ERROR = 0xFF
+};
+} // namespace Modbus
+
+#endif // HOST_MODBUS_TYPEDEFS_H
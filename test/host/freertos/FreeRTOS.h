@@ -0,0 +1,17 @@
+#ifndef HOST_FREERTOS_H
+#define HOST_FREERTOS_H
+
+// The native tests are single-threaded; locks only have to exist
+#include <cassert>
+#include <cstdint>
+
+typedef int BaseType_t;
+typedef uint32_t TickType_t;
+typedef void* SemaphoreHandle_t;
+
+#define pdTRUE 1
+#define pdFALSE 0
+#define portMAX_DELAY 0xFFFFFFFFUL
+#define configASSERT(x) assert(x)
+
+#endif // HOST_FREERTOS_H
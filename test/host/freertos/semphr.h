@@ -0,0 +1,37 @@
+#ifndef HOST_SEMPHR_H
+#define HOST_SEMPHR_H
+
+#include "FreeRTOS.h"
+
+inline SemaphoreHandle_t xSemaphoreCreateMutex()
+{
+	static int mutex;
+	return &mutex;
+}
+
+inline SemaphoreHandle_t xSemaphoreCreateRecursiveMutex()
+{
+	return xSemaphoreCreateMutex();
+}
+
+inline BaseType_t xSemaphoreTake(SemaphoreHandle_t, TickType_t)
+{
+	return pdTRUE;
+}
+
+inline BaseType_t xSemaphoreGive(SemaphoreHandle_t)
+{
+	return pdTRUE;
+}
+
+inline BaseType_t xSemaphoreTakeRecursive(SemaphoreHandle_t, TickType_t)
+{
+	return pdTRUE;
+}
+
+inline BaseType_t xSemaphoreGiveRecursive(SemaphoreHandle_t)
+{
+	return pdTRUE;
+}
+
+#endif // HOST_SEMPHR_H
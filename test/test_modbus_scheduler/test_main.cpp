@@ -0,0 +1,164 @@
+#include <unity.h>
+#include "ModbusScheduler.hpp"
+
+using namespace Node_Utility;
+
+struct Target
+{
+	uint32_t token = 0;
+};
+using Scheduler = ModbusScheduler<Target>;
+
+static Target target(uint32_t token)
+{
+	Target t;
+	t.token = token;
+	return t;
+}
+
+static ModbusMessage frame(uint16_t start)
+{
+	ModbusMessage message;
+	message.setMessage(1, Modbus::READ_HOLD_REGISTER, start, 10);
+	return message;
+}
+
+void setUp()
+{
+}
+
+void tearDown()
+{
+}
+
+static void test_higher_class_goes_first()
+{
+	Scheduler scheduler;
+	scheduler.enqueue(RequestPriority::DASHBOARD, target(1), frame(0));
+	scheduler.enqueue(RequestPriority::TEST_CRITICAL, target(2), frame(0));
+	scheduler.enqueue(RequestPriority::CONTROL, target(3), frame(0));
+
+	Scheduler::Entry entry;
+	TEST_ASSERT_TRUE(scheduler.next(entry));
+	TEST_ASSERT_EQUAL_UINT32(3, entry.target.token);
+	scheduler.complete(entry.target.token);
+	TEST_ASSERT_TRUE(scheduler.next(entry));
+	TEST_ASSERT_EQUAL_UINT32(2, entry.target.token);
+	scheduler.complete(entry.target.token);
+	TEST_ASSERT_TRUE(scheduler.next(entry));
+	TEST_ASSERT_EQUAL_UINT32(1, entry.target.token);
+	TEST_ASSERT_FALSE(scheduler.next(entry));
+}
+
+static void test_fifo_within_a_class()
+{
+	Scheduler scheduler;
+	for(uint32_t token = 1; token <= 3; ++token)
+		scheduler.enqueue(RequestPriority::TEST_CRITICAL, target(token), frame(0));
+
+	Scheduler::Entry entry;
+	for(uint32_t token = 1; token <= 3; ++token)
+	{
+		TEST_ASSERT_TRUE(scheduler.next(entry));
+		TEST_ASSERT_EQUAL_UINT32(token, entry.target.token);
+		scheduler.complete(token);
+	}
+}
+
+static void test_control_bypasses_in_flight_cap()
+{
+	Scheduler scheduler;
+	for(uint32_t token = 1; token <= Scheduler::MAX_IN_FLIGHT + 1; ++token)
+		scheduler.enqueue(RequestPriority::TEST_CRITICAL, target(token), frame(0));
+
+	Scheduler::Entry entry;
+	for(size_t i = 0; i < Scheduler::MAX_IN_FLIGHT; ++i)
+		TEST_ASSERT_TRUE(scheduler.next(entry));
+	TEST_ASSERT_EQUAL(Scheduler::MAX_IN_FLIGHT, scheduler.readsInFlight());
+	TEST_ASSERT_FALSE(scheduler.next(entry)); // Third read held back
+
+	scheduler.enqueue(RequestPriority::CONTROL, target(100), frame(0));
+	scheduler.enqueue(RequestPriority::CONTROL, target(101), frame(0));
+	TEST_ASSERT_TRUE(scheduler.next(entry));
+	TEST_ASSERT_EQUAL_UINT32(100, entry.target.token);
+	TEST_ASSERT_TRUE(scheduler.next(entry));
+	TEST_ASSERT_EQUAL_UINT32(101, entry.target.token);
+	TEST_ASSERT_EQUAL(Scheduler::MAX_IN_FLIGHT, scheduler.readsInFlight());
+	TEST_ASSERT_FALSE(scheduler.next(entry));
+
+	// Finishing a write frees nothing for reads, finishing a read does
+	scheduler.complete(100);
+	TEST_ASSERT_FALSE(scheduler.next(entry));
+	scheduler.complete(1);
+	TEST_ASSERT_TRUE(scheduler.next(entry));
+	TEST_ASSERT_EQUAL_UINT32(Scheduler::MAX_IN_FLIGHT + 1, entry.target.token);
+}
+
+static void test_reads_coalesce_on_token()
+{
+	Scheduler scheduler;
+	TEST_ASSERT_TRUE(scheduler.enqueue(RequestPriority::DASHBOARD, target(7), frame(0)));
+	TEST_ASSERT_TRUE(scheduler.enqueue(RequestPriority::DASHBOARD, target(8), frame(0)));
+	TEST_ASSERT_TRUE(scheduler.enqueue(RequestPriority::DASHBOARD, target(7), frame(40)));
+
+	TEST_ASSERT_EQUAL(2, scheduler.queued(RequestPriority::DASHBOARD));
+	TEST_ASSERT_EQUAL_UINT32(1, scheduler.stats(RequestPriority::DASHBOARD).coalesced);
+
+	// Keeps its place in line but carries the newest request
+	Scheduler::Entry entry;
+	TEST_ASSERT_TRUE(scheduler.next(entry));
+	TEST_ASSERT_EQUAL_UINT32(7, entry.target.token);
+	TEST_ASSERT_TRUE(entry.message == frame(40));
+}
+
+static void test_writes_never_coalesce()
+{
+	Scheduler scheduler;
+	scheduler.enqueue(RequestPriority::CONTROL, target(5), frame(0));
+	scheduler.enqueue(RequestPriority::CONTROL, target(5), frame(1));
+
+	TEST_ASSERT_EQUAL(2, scheduler.queued(RequestPriority::CONTROL));
+	TEST_ASSERT_EQUAL_UINT32(0, scheduler.stats(RequestPriority::CONTROL).coalesced);
+}
+
+static void test_full_class_drops()
+{
+	Scheduler scheduler;
+	for(uint32_t token = 1; token <= Scheduler::QUEUE_DEPTH; ++token)
+		TEST_ASSERT_TRUE(scheduler.enqueue(RequestPriority::DASHBOARD, target(token), frame(0)));
+	TEST_ASSERT_FALSE(scheduler.enqueue(RequestPriority::DASHBOARD, target(99), frame(0)));
+	TEST_ASSERT_EQUAL_UINT32(1, scheduler.stats(RequestPriority::DASHBOARD).dropped);
+
+	// Other classes have their own room
+	TEST_ASSERT_TRUE(scheduler.enqueue(RequestPriority::TEST_CRITICAL, target(99), frame(0)));
+}
+
+static void test_lost_callbacks_expire()
+{
+	Scheduler scheduler;
+	for(uint32_t token = 1; token <= Scheduler::MAX_IN_FLIGHT + 1; ++token)
+		scheduler.enqueue(RequestPriority::TEST_CRITICAL, target(token), frame(0));
+
+	Scheduler::Entry entry;
+	while(scheduler.next(entry))
+	{
+	}
+	TEST_ASSERT_EQUAL(1, scheduler.queuedTotal());
+
+	hostAdvance_us(Scheduler::STALE_IN_FLIGHT_US + 1);
+	TEST_ASSERT_TRUE(scheduler.next(entry));
+	TEST_ASSERT_EQUAL_UINT32(Scheduler::MAX_IN_FLIGHT + 1, entry.target.token);
+}
+
+int main()
+{
+	UNITY_BEGIN();
+	RUN_TEST(test_higher_class_goes_first);
+	RUN_TEST(test_fifo_within_a_class);
+	RUN_TEST(test_control_bypasses_in_flight_cap);
+	RUN_TEST(test_reads_coalesce_on_token);
+	RUN_TEST(test_writes_never_coalesce);
+	RUN_TEST(test_full_class_drops);
+	RUN_TEST(test_lost_callbacks_expire);
+	return UNITY_END();
+}
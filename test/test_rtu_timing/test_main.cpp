@@ -0,0 +1,63 @@
+#include <unity.h>
+#include "ModbusRtuTiming.hpp"
+
+using namespace Node_Utility;
+
+void setUp()
+{
+}
+
+void tearDown()
+{
+}
+
+static void test_three_and_a_half_characters_up_to_19200()
+{
+	// 8N1 is 10 bits a character: 35 bit times
+	TEST_ASSERT_EQUAL_UINT32(3646, rtuFrameGapUs(9600, 8, 0, 1));
+	TEST_ASSERT_EQUAL_UINT32(1823, rtuFrameGapUs(19200, 8, 0, 1));
+	TEST_ASSERT_EQUAL_UINT32(29167, rtuFrameGapUs(1200, 8, 0, 1));
+}
+
+static void test_parity_and_stop_bits_lengthen_the_character()
+{
+	TEST_ASSERT_EQUAL_UINT32(4011, rtuFrameGapUs(9600, 8, 2, 1)); // 8E1, 11 bits
+	TEST_ASSERT_EQUAL_UINT32(4011, rtuFrameGapUs(9600, 8, 0, 2)); // 8N2, 11 bits
+	TEST_ASSERT_EQUAL_UINT32(8750, rtuFrameGapUs(4800, 8, 1, 2)); // 8O2, 12 bits
+	TEST_ASSERT_EQUAL_UINT32(3646, rtuFrameGapUs(9600, 7, 2, 1)); // 7E1, 10 bits
+}
+
+static void test_fixed_above_19200()
+{
+	TEST_ASSERT_EQUAL_UINT32(1750, rtuFrameGapUs(19201, 8, 0, 1));
+	TEST_ASSERT_EQUAL_UINT32(1750, rtuFrameGapUs(38400, 8, 2, 1));
+	TEST_ASSERT_EQUAL_UINT32(1750, rtuFrameGapUs(115200, 8, 0, 1));
+}
+
+static void test_never_shorter_than_the_character_count()
+{
+	// Rounded up, so the gap is at least 3.5 characters at every supported rate
+	static const uint32_t bauds[] = {1200, 2400, 4800, 9600, 14400, 19200};
+	for(uint32_t baud: bauds)
+	{
+		uint32_t gap = rtuFrameGapUs(baud, 8, 2, 2);
+		TEST_ASSERT_TRUE(static_cast<uint64_t>(gap) * baud >= 12ULL * 3500000);
+		TEST_ASSERT_TRUE(static_cast<uint64_t>(gap - 1) * baud < 12ULL * 3500000);
+	}
+}
+
+static void test_unset_baud_rate()
+{
+	TEST_ASSERT_EQUAL_UINT32(0, rtuFrameGapUs(0, 8, 0, 1));
+}
+
+int main()
+{
+	UNITY_BEGIN();
+	RUN_TEST(test_three_and_a_half_characters_up_to_19200);
+	RUN_TEST(test_parity_and_stop_bits_lengthen_the_character);
+	RUN_TEST(test_fixed_above_19200);
+	RUN_TEST(test_never_shorter_than_the_character_count);
+	RUN_TEST(test_unset_baud_rate);
+	return UNITY_END();
+}
@@ -0,0 +1,2 @@
+/* The native env builds no sources outside test/, so the generated descriptors come in here */
+#include "report.pb.c"
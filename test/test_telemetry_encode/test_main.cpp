@@ -0,0 +1,174 @@
+#include <unity.h>
+#include <chrono>
+#include "telemetryEncode.hpp"
+
+// Encode time and size of one readings frame for two meters in each WebSocket format, through
+// the encoders DataHandler calls: fillReadingsJson() and encodeJsonFrame() as prepData() and
+// serializeFrame() use them, addTelemetryChannel() and encodeTelemetryFrame() for the full
+// TelemetryFrame, and DeltaTelemetry for a delta frame where one meter's current moved. Host
+// figures; the node keeps its own in jsonStats(), binaryStats() and deltaStats().
+
+using namespace Node_Core;
+
+static constexpr size_t WS_BUFFER_SIZE = 256; // DataHandler.h
+static constexpr int ROUNDS = 20000;
+
+static OutBox meter(float voltage, float current, float power, float pf, float frequency)
+{
+	OutBox box;
+	box.voltage = voltage;
+	box.current = current;
+	box.power = power;
+	box.powerfactor = pf;
+	box.frequency = frequency;
+	box.isValid = true;
+	return box;
+}
+
+static const OutBox input = meter(229.4f, 2.31f, 514.2f, 0.97f, 50.02f);
+static const OutBox output = meter(230.1f, 1.87f, 401.7f, 0.93f, 49.98f);
+
+// What DataHandler::fillTelemetry() builds from the meter registry
+static void fill(pg_TelemetryFrame& frame, const OutBox& out)
+{
+	frame = pg_TelemetryFrame();
+	frame.timestamp_ms = 3600000;
+	frame.state = 4;
+	addTelemetryChannel(frame, pg_PowerMeasureType_UPS_INPUT, 1, input);
+	addTelemetryChannel(frame, pg_PowerMeasureType_UPS_OUTPUT, 2, out);
+}
+
+static SharedFrame encodeJson()
+{
+	JsonDocument doc;
+	fillReadingsJson(doc, input, output);
+	SharedFrame frame;
+	encodeJsonFrame(doc, WS_BUFFER_SIZE, frame);
+	return frame;
+}
+
+static pg_TelemetryFrame frame;
+
+static SharedFrame encodeFull()
+{
+	fill(frame, output);
+	frame.sequence = 1200;
+	frame.key_frame = true;
+	const char* error = nullptr;
+	return encodeTelemetryFrame(frame, error);
+}
+
+// A stream past its key frame, with output current alternating across the deadband; every
+// TELEMETRY_KEY_FRAME_INTERVAL frames one is a key frame again, as on the node
+static DeltaTelemetry stream;
+static bool moved = false;
+
+static SharedFrame encodeDelta()
+{
+	moved = !moved;
+	fill(frame, meter(230.1f, moved ? 1.95f : 1.87f, 401.7f, 0.93f, 49.98f));
+	stream.next(frame);
+	const char* error = nullptr;
+	return encodeTelemetryFrame(frame, error);
+}
+
+struct Encoded
+{
+	size_t bytes = 0;
+	double us = 0;
+};
+
+template<typename Encode>
+static Encoded measure(Encode encode)
+{
+	Encoded result;
+	SharedFrame first = encode();
+	result.bytes = first ? first->size() : 0;
+
+	auto started = std::chrono::steady_clock::now();
+	for(int round = 0; round < ROUNDS; ++round)
+		encode();
+	auto elapsed = std::chrono::steady_clock::now() - started;
+	result.us = std::chrono::duration<double, std::micro>(elapsed).count() / ROUNDS;
+	return result;
+}
+
+void setUp()
+{
+	stream = DeltaTelemetry();
+	moved = false;
+}
+
+void tearDown()
+{
+}
+
+static void test_delta_stream()
+{
+	fill(frame, output);
+	stream.next(frame);
+	TEST_ASSERT_TRUE(frame.key_frame);
+	TEST_ASSERT_EQUAL(2, frame.channels_count);
+
+	// Inside every deadband: nothing to send
+	fill(frame, meter(230.2f, 1.88f, 401.9f, 0.93f, 49.99f));
+	stream.next(frame);
+	TEST_ASSERT_FALSE(frame.key_frame);
+	TEST_ASSERT_EQUAL(0, frame.channels_count);
+
+	fill(frame, meter(230.1f, 1.95f, 401.7f, 0.93f, 49.98f));
+	stream.next(frame);
+	TEST_ASSERT_EQUAL(1, frame.channels_count);
+	TEST_ASSERT_EQUAL(2, frame.channels[0].meter_id);
+	TEST_ASSERT_EQUAL(1u << pg_PowerMeasure_current_tag, frame.channels[0].changed);
+
+	// The baseline followed the current, not the other fields
+	stream.keyFrame(frame);
+	TEST_ASSERT_TRUE(frame.key_frame);
+	TEST_ASSERT_EQUAL(2, frame.channels_count);
+	TEST_ASSERT_TRUE(frame.channels[1].current == 1.95f);
+	TEST_ASSERT_TRUE(frame.channels[1].voltage == 230.1f);
+
+	for(uint32_t i = 3; i < TELEMETRY_KEY_FRAME_INTERVAL; ++i)
+	{
+		fill(frame, output);
+		stream.next(frame);
+		TEST_ASSERT_FALSE(frame.key_frame);
+	}
+	fill(frame, output);
+	stream.next(frame);
+	TEST_ASSERT_TRUE(frame.key_frame);
+	TEST_ASSERT_EQUAL(TELEMETRY_KEY_FRAME_INTERVAL + 1, frame.sequence);
+}
+
+static void test_formats()
+{
+	Encoded json = measure(encodeJson);
+	Encoded full = measure(encodeFull);
+	fill(frame, output);
+	stream.next(frame); // Key frame out of the way
+	Encoded delta = measure(encodeDelta);
+
+	char line[96];
+	snprintf(line, sizeof(line), "JSON      %3zu B  %.2f us", json.bytes, json.us);
+	TEST_MESSAGE(line);
+	snprintf(line, sizeof(line), "protobuf  %3zu B  %.2f us", full.bytes, full.us);
+	TEST_MESSAGE(line);
+	snprintf(line, sizeof(line), "delta     %3zu B  %.2f us", delta.bytes, delta.us);
+	TEST_MESSAGE(line);
+
+	TEST_ASSERT_TRUE(json.bytes > 0);
+	TEST_ASSERT_TRUE(full.bytes > 0);
+	TEST_ASSERT_TRUE(delta.bytes > 0);
+	TEST_ASSERT_TRUE(full.bytes < json.bytes);
+	TEST_ASSERT_TRUE(delta.bytes < full.bytes);
+	TEST_ASSERT_TRUE(full.bytes <= pg_TelemetryFrame_size);
+}
+
+int main()
+{
+	UNITY_BEGIN();
+	RUN_TEST(test_delta_stream);
+	RUN_TEST(test_formats);
+	return UNITY_END();
+}
@@ -0,0 +1,144 @@
+#include <unity.h>
+#include <ArduinoJson.h>
+#include <algorithm>
+#include <chrono>
+#include <vector>
+#include "AllocationCounter.h"
+#include "wsFrame.hpp"
+
+// One broadcast of the readings frame to 1, 8 and 32 clients through encodeJsonFrame, the
+// serializer behind DataHandler::serializeFrame: once per client, as every client used to get
+// its own serialization and buffer, against once per broadcast with the frame shared. Clients
+// hold their last frame only; the library's per-message queue entry costs the same on both
+// paths and is left out.
+
+using namespace Node_Core;
+
+static constexpr size_t WS_BUFFER_SIZE = 256; // DataHandler.h
+static constexpr int ROUNDS = 2000;
+
+struct Client
+{
+	SharedFrame frame;
+};
+
+static JsonDocument readings()
+{
+	JsonDocument doc;
+	doc["inputCurrent"] = 2.31f;
+	doc["outputCurrent"] = 1.87f;
+	doc["inputVoltage"] = 229.4f;
+	doc["outputVoltage"] = 230.1f;
+	doc["inputPowerFactor"] = 0.97f;
+	doc["outputPowerFactor"] = 0.93f;
+	doc["inputWattage"] = 514.2f;
+	doc["outputWattage"] = 401.7f;
+	return doc;
+}
+
+static void perClient(std::vector<Client>& clients)
+{
+	for(Client& client: clients)
+		encodeJsonFrame(readings(), WS_BUFFER_SIZE, client.frame);
+}
+
+static void shared(std::vector<Client>& clients)
+{
+	SharedFrame frame;
+	encodeJsonFrame(readings(), WS_BUFFER_SIZE, frame);
+	for(Client& client: clients)
+		client.frame = frame;
+}
+
+struct Cost
+{
+	double us = 0;
+	double allocations = 0;
+};
+
+template<typename Broadcast>
+static Cost measure(size_t clientCount, Broadcast broadcast)
+{
+	std::vector<Client> clients(clientCount);
+	broadcast(clients);
+
+	long before = hostAllocations();
+	auto started = std::chrono::steady_clock::now();
+	for(int round = 0; round < ROUNDS; ++round)
+		broadcast(clients);
+	auto elapsed = std::chrono::steady_clock::now() - started;
+
+	Cost cost;
+	cost.us = std::chrono::duration<double, std::micro>(elapsed).count() / ROUNDS;
+	cost.allocations = static_cast<double>(hostAllocations() - before) / ROUNDS;
+	return cost;
+}
+
+void setUp()
+{
+}
+
+void tearDown()
+{
+}
+
+static void test_frame_is_the_json_alone()
+{
+	JsonDocument doc = readings();
+	char json[WS_BUFFER_SIZE];
+	size_t len = serializeJson(doc, json, sizeof(json));
+
+	SharedFrame frame;
+	TEST_ASSERT_TRUE(encodeJsonFrame(doc, WS_BUFFER_SIZE, frame) == FrameError::NONE);
+	TEST_ASSERT_NOT_NULL(frame.get());
+	TEST_ASSERT_EQUAL(len, frame->size());
+	TEST_ASSERT_TRUE(std::equal(frame->begin(), frame->end(), json));
+}
+
+static void test_rejects_what_serializeFrame_rejects()
+{
+	SharedFrame frame;
+	TEST_ASSERT_TRUE(encodeJsonFrame(JsonDocument(), WS_BUFFER_SIZE, frame) ==
+					 FrameError::NO_DOCUMENT);
+	TEST_ASSERT_NULL(frame.get());
+
+	JsonDocument doc = readings();
+	TEST_ASSERT_TRUE(encodeJsonFrame(doc, measureJson(doc), frame) == FrameError::TOO_LONG);
+	TEST_ASSERT_NULL(frame.get());
+
+	const char bad[] = {'a', static_cast<char>(0xFF), 'b'};
+	TEST_ASSERT_FALSE(isValidUTF8(bad, sizeof(bad)));
+	const char degrees[] = {static_cast<char>(0xC2), static_cast<char>(0xB0), 'C'};
+	TEST_ASSERT_TRUE(isValidUTF8(degrees, sizeof(degrees)));
+}
+
+static void test_shared_frame_scales_with_clients()
+{
+	Cost sharedOne = measure(1, shared);
+	static const size_t clientCounts[] = {1, 8, 32};
+	for(size_t clientCount: clientCounts)
+	{
+		Cost before = measure(clientCount, perClient);
+		Cost after = measure(clientCount, shared);
+
+		char line[128];
+		snprintf(line, sizeof(line),
+				 "%2zu clients: %.1f us -> %.1f us, %.0f -> %.0f heap allocations", clientCount,
+				 before.us, after.us, before.allocations, after.allocations);
+		TEST_MESSAGE(line);
+
+		TEST_ASSERT_TRUE(before.allocations >= clientCount * sharedOne.allocations);
+		TEST_ASSERT_TRUE(after.allocations == sharedOne.allocations);
+		if(clientCount > 1)
+			TEST_ASSERT_TRUE(after.us < before.us);
+	}
+}
+
+int main()
+{
+	UNITY_BEGIN();
+	RUN_TEST(test_frame_is_the_json_alone);
+	RUN_TEST(test_rejects_what_serializeFrame_rejects);
+	RUN_TEST(test_shared_frame_scales_with_clients);
+	return UNITY_END();
+}
@@ -0,0 +1,174 @@
+#include <unity.h>
+#include <chrono>
+#include <string>
+#include <vector>
+#include "wsCommandTable.hpp"
+
+using namespace Node_Core;
+
+static wsIncomingCommands lookup(const std::string& text)
+{
+	const WsCommandName* command = findWsCommand(text.data(), text.size());
+	return command != nullptr ? command->cmd : wsIncomingCommands::INVALID_COMMAND;
+}
+
+// The if/strcmp chain the table replaced, walking the same names in order
+static wsIncomingCommands chain(const char* data, size_t len)
+{
+	char message[256];
+	memcpy(message, data, len);
+	message[len] = '\0';
+	for(const WsCommandName& command: WS_COMMANDS)
+	{
+		if(strcmp(message, command.text) == 0)
+			return command.cmd;
+	}
+	return wsIncomingCommands::INVALID_COMMAND;
+}
+
+// Strings one edit away from a command name
+static std::vector<std::string> nearMisses(const WsCommandName& command)
+{
+	std::string name(command.text, command.len);
+	std::vector<std::string> misses;
+	for(size_t len = 0; len < name.size(); ++len)
+		misses.push_back(name.substr(0, len));
+	misses.push_back(name + " ");
+	misses.push_back(" " + name);
+	misses.push_back(name + "\n");
+	misses.push_back(name + std::string(1, '\0'));
+	misses.push_back(name + name);
+	for(size_t i = 0; i < name.size(); ++i)
+	{
+		std::string flipped = name;
+		char c = flipped[i];
+		if(c >= 'a' && c <= 'z')
+			flipped[i] = c - 'a' + 'A';
+		else if(c >= 'A' && c <= 'Z')
+			flipped[i] = c - 'A' + 'a';
+		else
+			flipped[i] = c + 1;
+		misses.push_back(flipped);
+
+		std::string dropped = name;
+		dropped.erase(i, 1);
+		misses.push_back(dropped);
+	}
+	return misses;
+}
+
+static bool isCommand(const std::string& text)
+{
+	for(const WsCommandName& command: WS_COMMANDS)
+	{
+		if(text == std::string(command.text, command.len))
+			return true;
+	}
+	return false;
+}
+
+void setUp()
+{
+}
+
+void tearDown()
+{
+}
+
+static void test_every_name_is_found()
+{
+	for(const WsCommandName& command: WS_COMMANDS)
+	{
+		const WsCommandName* found = findWsCommand(command.text, command.len);
+		TEST_ASSERT_TRUE(found == &command);
+	}
+}
+
+static void test_names_need_no_terminator()
+{
+	for(const WsCommandName& command: WS_COMMANDS)
+	{
+		std::string framed = std::string(command.text, command.len) + "garbage";
+		const WsCommandName* found = findWsCommand(framed.data(), command.len);
+		TEST_ASSERT_TRUE(found == &command);
+	}
+}
+
+static void test_near_misses_are_rejected()
+{
+	for(const WsCommandName& command: WS_COMMANDS)
+	{
+		for(const std::string& miss: nearMisses(command))
+		{
+			if(isCommand(miss))
+				continue; // One name's miss may be another name
+			if(lookup(miss) != wsIncomingCommands::INVALID_COMMAND)
+				TEST_FAIL_MESSAGE(miss.c_str());
+		}
+	}
+	TEST_ASSERT_TRUE(lookup("") == wsIncomingCommands::INVALID_COMMAND);
+	TEST_ASSERT_TRUE(lookup("format:xml") == wsIncomingCommands::INVALID_COMMAND);
+	TEST_ASSERT_TRUE(lookup("{\"type\":\"start\"}") == wsIncomingCommands::INVALID_COMMAND);
+}
+
+static void test_matches_strcmp_chain()
+{
+	for(const WsCommandName& command: WS_COMMANDS)
+	{
+		TEST_ASSERT_TRUE(chain(command.text, command.len) == lookup(command.text));
+		for(const std::string& miss: nearMisses(command))
+		{
+			// The chain stopped at an embedded NUL; the table rightly does not
+			if(miss.find('\0') != std::string::npos)
+				continue;
+			TEST_ASSERT_TRUE(chain(miss.data(), miss.size()) == lookup(miss));
+		}
+	}
+}
+
+// Not a pass/fail check: prints the cost per parse of both lookups over the names and a set of
+// misses, for comparison with the device
+static void test_lookup_speed()
+{
+	std::vector<std::string> inputs;
+	for(const WsCommandName& command: WS_COMMANDS)
+		inputs.emplace_back(command.text, command.len);
+	for(const char* miss: {"bogus", "format:xml", "", "Start", "Mains  On", "getreadings"})
+		inputs.emplace_back(miss);
+
+	const int rounds = 200000;
+	double ns[2];
+	for(int method = 0; method < 2; ++method)
+	{
+		volatile int sink = 0;
+		auto started = std::chrono::steady_clock::now();
+		for(int round = 0; round < rounds; ++round)
+		{
+			for(const std::string& input: inputs)
+			{
+				wsIncomingCommands cmd =
+					method == 0 ? chain(input.data(), input.size()) : lookup(input);
+				sink = sink + static_cast<int>(cmd);
+			}
+		}
+		auto elapsed = std::chrono::steady_clock::now() - started;
+		ns[method] = std::chrono::duration<double, std::nano>(elapsed).count() /
+					 (static_cast<double>(rounds) * inputs.size());
+	}
+
+	char line[96];
+	snprintf(line, sizeof(line), "strcmp chain %.1f ns/parse, hash table %.1f ns/parse", ns[0],
+			 ns[1]);
+	TEST_MESSAGE(line);
+}
+
+int main()
+{
+	UNITY_BEGIN();
+	RUN_TEST(test_every_name_is_found);
+	RUN_TEST(test_names_need_no_terminator);
+	RUN_TEST(test_near_misses_are_rejected);
+	RUN_TEST(test_matches_strcmp_chain);
+	RUN_TEST(test_lookup_speed);
+	return UNITY_END();
+}